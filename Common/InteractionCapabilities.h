@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "TEST_InteractionCapabilities.generated.h"
+
+// What actor can do or what can be done with it
+UENUM(meta = (Bitflags, UseEnumValuesAsMaskValuesInEditor = "true"))
+enum class ETESTInteractionCapability : uint8
+{
+	None			= 0,
+	Interactable	= 1 << 0,
+	Pickup			= 1 << 1,
+	Consumable		= 1 << 2,
+	Destructible	= 1 << 3,
+	Projectile		= 1 << 4,
+};
+ENUM_CLASS_FLAGS(ETESTInteractionCapability);
+
+/**
+ * Native base of actors with capabilities set in constructor. Hot paths
+ * do one class cast, which is constant time for native classes, and
+ * test bits instead of walking class hierarchy or interface lists
+ */
+UCLASS(Abstract, NotPlaceable)
+class TEST_API ATEST_CapabilityActor : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ETESTInteractionCapability GetInteractionCapabilities() const { return InteractionCapabilities; }
+
+	bool HasInteractionCapability(ETESTInteractionCapability Capability) const
+	{
+		return EnumHasAllFlags(InteractionCapabilities, Capability);
+	}
+
+	// Capabilities of any actor, None if actor is not ATEST_CapabilityActor
+	static ETESTInteractionCapability GetCapabilities(const AActor* Actor)
+	{
+		const ATEST_CapabilityActor* CapabilityActor = Cast<const ATEST_CapabilityActor>(Actor);
+		return CapabilityActor != nullptr ? CapabilityActor->InteractionCapabilities : ETESTInteractionCapability::None;
+	}
+
+protected:
+	// Set in constructors, every subclass adds own flags
+	ETESTInteractionCapability InteractionCapabilities = ETESTInteractionCapability::None;
+};
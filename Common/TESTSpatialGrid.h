@@ -0,0 +1,214 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Uniform hash grid storing elements with their last known location.
+ * Queries do not touch elements, only stored locations, so they are
+ * cheap even for many thousands of elements
+ */
+template<typename ElementType>
+class TTESTSpatialGrid
+{
+public:
+	explicit TTESTSpatialGrid(float InCellSize = 1000.f)
+		: CellSize(InCellSize)
+		, InvCellSize(1.f / InCellSize)
+	{
+	}
+
+	// Change size of cells, allowed only when grid is empty
+	void SetCellSize(float InCellSize)
+	{
+		check(Num() == 0);
+		CellSize = InCellSize;
+		InvCellSize = 1.f / InCellSize;
+	}
+
+	int32 Num() const { return ElementCells.Num(); }
+
+	bool Contains(ElementType Element) const { return ElementCells.Contains(Element); }
+
+	void Add(ElementType Element, const FVector& Location)
+	{
+		if (ElementCells.Contains(Element))
+		{
+			Update(Element, Location);
+			return;
+		}
+		const FIntVector Cell = GetCell(Location);
+		ElementCells.Add(Element, Cell);
+		Cells.FindOrAdd(Cell).Add(FEntry{ Element, Location });
+	}
+
+	void Remove(ElementType Element)
+	{
+		FIntVector Cell;
+		if (ElementCells.RemoveAndCopyValue(Element, Cell))
+		{
+			RemoveFromCell(Cell, Element);
+		}
+	}
+
+	// Store new location, move element to other cell only if needed
+	void Update(ElementType Element, const FVector& Location)
+	{
+		FIntVector* CurrentCell = ElementCells.Find(Element);
+		if (CurrentCell == nullptr)
+		{
+			return;
+		}
+		const FIntVector NewCell = GetCell(Location);
+		if (NewCell == *CurrentCell)
+		{
+			for (FEntry& Entry : Cells.FindChecked(NewCell))
+			{
+				if (Entry.Element == Element)
+				{
+					Entry.Location = Location;
+					break;
+				}
+			}
+			return;
+		}
+		RemoveFromCell(*CurrentCell, Element);
+		*CurrentCell = NewCell;
+		Cells.FindOrAdd(NewCell).Add(FEntry{ Element, Location });
+	}
+
+	// Call Func(Element, Location) for every element inside sphere
+	template<typename FuncType>
+	void ForEachInRadius(const FVector& Origin, float Radius, FuncType Func) const
+	{
+		VisitInRadius(Origin, Radius, [&Func](ElementType Element, const FVector& Location)
+		{
+			Func(Element, Location);
+			return true;
+		});
+	}
+
+	// True if any element is inside sphere, stops on first one
+	bool AnyInRadius(const FVector& Origin, float Radius) const
+	{
+		bool bFound = false;
+		VisitInRadius(Origin, Radius, [&bFound](ElementType Element, const FVector& Location)
+		{
+			bFound = true;
+			return false;
+		});
+		return bFound;
+	}
+
+	// Number of populated cells
+	int32 NumCells() const { return Cells.Num(); }
+
+	void Empty()
+	{
+		Cells.Empty();
+		ElementCells.Empty();
+	}
+
+private:
+	struct FEntry
+	{
+		ElementType Element;
+		FVector Location;
+	};
+
+	// Call Visitor(Element, Location) for elements inside sphere until it returns false.
+	// Cost is bounded by populated cells, large radius does not probe empty cells
+	template<typename VisitorType>
+	void VisitInRadius(const FVector& Origin, float Radius, VisitorType Visitor) const
+	{
+		if (Cells.Num() == 0 || Radius < 0.f)
+		{
+			return;
+		}
+		Radius = FMath::Min(Radius, static_cast<float>(WORLD_MAX));
+		const float RadiusSquared = Radius * Radius;
+		const FIntVector MinCell = GetCell(Origin - FVector(Radius));
+		const FIntVector MaxCell = GetCell(Origin + FVector(Radius));
+
+		auto VisitEntries = [&](const TArray<FEntry>& Entries)
+		{
+			for (const FEntry& Entry : Entries)
+			{
+				if (FVector::DistSquared(Entry.Location, Origin) <= RadiusSquared && !Visitor(Entry.Element, Entry.Location))
+				{
+					return false;
+				}
+			}
+			return true;
+		};
+
+		const int64 NumBoxCells = int64(MaxCell.X - MinCell.X + 1) * int64(MaxCell.Y - MinCell.Y + 1) * int64(MaxCell.Z - MinCell.Z + 1);
+		if (NumBoxCells > Cells.Num())
+		{
+			// Fewer populated cells than cells in bounding box
+			for (const TPair<FIntVector, TArray<FEntry>>& Pair : Cells)
+			{
+				const FIntVector& Cell = Pair.Key;
+				if (Cell.X >= MinCell.X && Cell.X <= MaxCell.X
+					&& Cell.Y >= MinCell.Y && Cell.Y <= MaxCell.Y
+					&& Cell.Z >= MinCell.Z && Cell.Z <= MaxCell.Z
+					&& !VisitEntries(Pair.Value))
+				{
+					return;
+				}
+			}
+			return;
+		}
+
+		for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+		{
+			for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+			{
+				for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+				{
+					const TArray<FEntry>* Entries = Cells.Find(FIntVector(X, Y, Z));
+					if (Entries != nullptr && !VisitEntries(*Entries))
+					{
+						return;
+					}
+				}
+			}
+		}
+	}
+
+	FIntVector GetCell(const FVector& Location) const
+	{
+		return FIntVector(
+			FMath::FloorToInt(Location.X * InvCellSize),
+			FMath::FloorToInt(Location.Y * InvCellSize),
+			FMath::FloorToInt(Location.Z * InvCellSize));
+	}
+
+	void RemoveFromCell(const FIntVector& Cell, ElementType Element)
+	{
+		TArray<FEntry>* Entries = Cells.Find(Cell);
+		if (Entries == nullptr)
+		{
+			return;
+		}
+		const int32 Index = Entries->IndexOfByPredicate([Element](const FEntry& Entry) { return Entry.Element == Element; });
+		if (Index != INDEX_NONE)
+		{
+			Entries->RemoveAtSwap(Index, 1, false);
+		}
+		if (Entries->Num() == 0)
+		{
+			Cells.Remove(Cell);
+		}
+	}
+
+	float CellSize;
+	float InvCellSize;
+
+	// Elements stored in every cell
+	TMap<FIntVector, TArray<FEntry>> Cells;
+
+	// Cell of every element
+	TMap<ElementType, FIntVector> ElementCells;
+};
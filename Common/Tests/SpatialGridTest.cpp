@@ -0,0 +1,177 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "Components/ShapeComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "Engine/TriggerSphere.h"
+#include "TESTAutomationWorld.h"
+#include "TESTSpatialGrid.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace TESTSpatialGridTest
+{
+	// Elements are indices to locations, spread in cube around origin
+	void FillGrid(TTESTSpatialGrid<int32>& Grid, TArray<FVector>& Locations, int32 Count, float Extent, int32 Seed)
+	{
+		FRandomStream Random(Seed);
+		Locations.Reset(Count);
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			const FVector Location(Random.FRandRange(-Extent, Extent), Random.FRandRange(-Extent, Extent), Random.FRandRange(-Extent, Extent));
+			Locations.Add(Location);
+			Grid.Add(Index, Location);
+		}
+	}
+
+	// Reference result without grid
+	TArray<int32> BruteForceInRadius(const TArray<FVector>& Locations, const FVector& Origin, float Radius)
+	{
+		TArray<int32> Result;
+		for (int32 Index = 0; Index < Locations.Num(); ++Index)
+		{
+			if (FVector::DistSquared(Locations[Index], Origin) <= Radius * Radius)
+			{
+				Result.Add(Index);
+			}
+		}
+		return Result;
+	}
+
+	TArray<int32> GridInRadius(const TTESTSpatialGrid<int32>& Grid, const FVector& Origin, float Radius)
+	{
+		TArray<int32> Result;
+		Grid.ForEachInRadius(Origin, Radius, [&Result](int32 Element, const FVector& Location)
+		{
+			Result.Add(Element);
+		});
+		Result.Sort();
+		return Result;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTESTSpatialGridRadiusTest, "TEST.SpatialGrid.Radius", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTESTSpatialGridRadiusTest::RunTest(const FString& Parameters)
+{
+	using namespace TESTSpatialGridTest;
+
+	TTESTSpatialGrid<int32> Grid(500.f);
+	TArray<FVector> Locations;
+	FillGrid(Grid, Locations, 2000, 5000.f, 7);
+
+	// Small radius probes cells, huge radius walks populated cells, both must match
+	const float Radii[] = { 0.f, 250.f, 1200.f, 4000.f, 1.0e7f };
+	for (const float Radius : Radii)
+	{
+		const FVector Origin(130.f, -470.f, 900.f);
+		TestEqual(*FString::Printf(TEXT("Elements in radius %.0f"), Radius), GridInRadius(Grid, Origin, Radius), BruteForceInRadius(Locations, Origin, Radius));
+		TestEqual(*FString::Printf(TEXT("Any in radius %.0f"), Radius), Grid.AnyInRadius(Origin, Radius), BruteForceInRadius(Locations, Origin, Radius).Num() > 0);
+	}
+
+	// Moved element is found only at new location
+	Grid.Update(0, FVector(100000.f));
+	TestTrue(TEXT("Moved element found at new location"), GridInRadius(Grid, FVector(100000.f), 1.f).Contains(0));
+	TestFalse(TEXT("Moved element not found at old location"), GridInRadius(Grid, Locations[0], 1.f).Contains(0));
+
+	Grid.Remove(0);
+	TestFalse(TEXT("Removed element not found"), Grid.AnyInRadius(FVector(100000.f), 1.f));
+	TestEqual(TEXT("Element count after remove"), Grid.Num(), Locations.Num() - 1);
+	return true;
+}
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FTESTSpatialGridBenchmark, "TEST.SpatialGrid.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+void FTESTSpatialGridBenchmark::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	for (const int32 NumElements : { 10000, 100000 })
+	{
+		OutBeautifiedNames.Add(FString::Printf(TEXT("%d"), NumElements));
+		OutTestCommands.Add(FString::FromInt(NumElements));
+	}
+}
+
+bool FTESTSpatialGridBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace TESTSpatialGridTest;
+
+	const int32 NumElements = FCString::Atoi(*Parameters);
+	const int32 NumQueries = 10000;
+	const float QueryRadius = 250.f;
+	TTESTSpatialGrid<int32> Grid(1000.f);
+	TArray<FVector> Locations;
+	FillGrid(Grid, Locations, NumElements, 50000.f, 11);
+
+	// Viewers stand close to random elements and look in random direction
+	FRandomStream Random(13);
+	TArray<FVector> Origins;
+	TArray<FVector> Directions;
+	for (int32 Index = 0; Index < NumQueries; ++Index)
+	{
+		Origins.Add(Locations[Random.RandHelper(NumElements)] + Random.GetUnitVector() * 150.f);
+		Directions.Add(Random.GetUnitVector());
+	}
+
+	// Interaction sized queries, grid against scan of all elements
+	int32 GridFound = 0;
+	double StartTime = FPlatformTime::Seconds();
+	for (const FVector& Origin : Origins)
+	{
+		Grid.ForEachInRadius(Origin, QueryRadius, [&GridFound](int32 Element, const FVector& Location) { ++GridFound; });
+	}
+	const double GridTime = FPlatformTime::Seconds() - StartTime;
+
+	int32 ScanFound = 0;
+	StartTime = FPlatformTime::Seconds();
+	for (const FVector& Origin : Origins)
+	{
+		ScanFound += BruteForceInRadius(Locations, Origin, QueryRadius).Num();
+	}
+	const double ScanTime = FPlatformTime::Seconds() - StartTime;
+	TestEqual(TEXT("Grid and scan find same elements"), GridFound, ScanFound);
+
+	// Radius covering whole world must cost no more than walking populated cells
+	StartTime = FPlatformTime::Seconds();
+	bool bAny = false;
+	for (int32 Index = 0; Index < 100; ++Index)
+	{
+		bAny |= Grid.AnyInRadius(FVector(1.0e6f), 1.0e7f);
+	}
+	const double HugeRadiusTime = FPlatformTime::Seconds() - StartTime;
+	TestTrue(TEXT("Huge radius finds elements"), bAny);
+
+	// Old interaction, trace from view and check class of whatever was hit
+	FTEST_AutomationWorld World;
+	for (const FVector& Location : Locations)
+	{
+		ATriggerSphere* Pickup = World->SpawnActor<ATriggerSphere>(Location, FRotator::ZeroRotator);
+		Pickup->GetCollisionComponent()->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+	}
+	int32 TraceFound = 0;
+	FHitResult Hit;
+	const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(TESTSpatialGridBenchmark));
+	StartTime = FPlatformTime::Seconds();
+	for (int32 Index = 0; Index < NumQueries; ++Index)
+	{
+		const FVector End = Origins[Index] + Directions[Index] * QueryRadius;
+		if (World->LineTraceSingleByChannel(Hit, Origins[Index], End, ECC_Visibility, QueryParams)
+			&& Hit.GetActor() != nullptr && Hit.GetActor()->GetClass()->IsChildOf(ATriggerSphere::StaticClass()))
+		{
+			++TraceFound;
+		}
+	}
+	const double TraceTime = FPlatformTime::Seconds() - StartTime;
+	TestTrue(TEXT("Traces hit elements"), TraceFound > 0);
+
+	AddInfo(FString::Printf(TEXT("%d elements in %d cells, %d queries of radius %.0f: grid %.3f ms, scan %.3f ms"),
+		NumElements, Grid.NumCells(), NumQueries, QueryRadius, GridTime * 1000.0, ScanTime * 1000.0));
+	AddInfo(FString::Printf(TEXT("%d line traces of length %.0f with class check: %.3f ms (%d hit, grid found %d in radius)"),
+		NumQueries, QueryRadius, TraceTime * 1000.0, TraceFound, GridFound));
+	AddInfo(FString::Printf(TEXT("100 AnyInRadius with radius 1e7: %.3f ms"), HugeRadiusTime * 1000.0));
+	return true;
+}
+
+#endif
@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+#include "GameFramework/WorldSettings.h"
+#include "UObject/UObjectGlobals.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/**
+ * Empty game world living as long as this object, used by automation
+ * tests. Needs no map, viewport or game mode, so tests run headless.
+ * Net mode is standalone, or dedicated server when run with -server
+ */
+class FTEST_AutomationWorld
+{
+public:
+	FTEST_AutomationWorld()
+	{
+		World = UWorld::CreateWorld(EWorldType::Game, false);
+		FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+		WorldContext.SetCurrentWorld(World);
+
+		World->InitializeActorsForPlay(FURL());
+		World->BeginPlay();
+		// Without game mode nothing starts play, actors spawned later get BeginPlay
+		World->GetWorldSettings()->NotifyBeginPlay();
+	}
+
+	~FTEST_AutomationWorld()
+	{
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+		CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	}
+
+	UWorld* Get() const { return World; }
+	UWorld* operator->() const { return World; }
+
+	// Tick actors, timers and tickable objects, every tick is a new engine frame
+	void Tick(float DeltaTime, int32 NumFrames = 1)
+	{
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			++GFrameCounter;
+			World->Tick(LEVELTICK_All, DeltaTime);
+		}
+	}
+
+private:
+	UWorld* World;
+};
+
+#endif
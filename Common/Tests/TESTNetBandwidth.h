@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Serialization/BitReader.h"
+#include "Serialization/BitWriter.h"
+#include "Templates/Function.h"
+#include "TESTAutomationWorld.h"
+#include "TESTNetTestSession.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace TESTNetBandwidth
+{
+	// Write value with its NetSerialize and read it back, returns written bits
+	template<typename StructType>
+	int64 RoundTrip(const StructType& Value, StructType& OutValue)
+	{
+		StructType Sent = Value;
+		bool bSuccess = false;
+		FBitWriter Writer(0, true);
+		Sent.NetSerialize(Writer, nullptr, bSuccess);
+
+		FBitReader Reader(Writer.GetData(), Writer.GetNumBits());
+		OutValue.NetSerialize(Reader, nullptr, bSuccess);
+		return Writer.GetNumBits();
+	}
+
+	// Tick world and session for NumFrames, Update runs before every frame.
+	// Returns bytes sent to each client meanwhile, headers and acks included
+	inline TArray<int64> MeasureClientBytes(FTEST_AutomationWorld& World, FTEST_NetTestSession& Session, int32 NumFrames, float DeltaTime, TFunctionRef<void(int32 Frame)> Update)
+	{
+		TArray<int64> Bytes;
+		for (int32 Client = 0; Client < Session.NumClients(); ++Client)
+		{
+			Bytes.Add(-Session.GetOutBytes(Client));
+		}
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			Update(Frame);
+			World.Tick(DeltaTime);
+			Session.Tick(DeltaTime);
+		}
+		for (int32 Client = 0; Client < Session.NumClients(); ++Client)
+		{
+			Bytes[Client] += Session.GetOutBytes(Client);
+		}
+		return Bytes;
+	}
+
+	// Bytes one client got more in Measured than in Baseline of same length
+	inline int64 GetExtraBytes(const TArray<int64>& Measured, const TArray<int64>& Baseline, int32 Client)
+	{
+		return FMath::Max<int64>(Measured[Client] - Baseline[Client], 0);
+	}
+}
+
+#endif
@@ -0,0 +1,117 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/Engine.h"
+#include "Engine/NetConnection.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/PlatformTime.h"
+#include "UObject/Package.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+/**
+ * Listen server on automation world with simulated client connections.
+ * Connections send nothing, but net driver replicates to them and counts
+ * bytes as for real clients. Every client views world from its player
+ * controller, move it to change what is relevant. Net driver is ticked
+ * by Tick, apart from world tick, so its cost can be measured alone
+ */
+class FTEST_NetTestSession
+{
+public:
+	FTEST_NetTestSession(UWorld* InWorld, int32 NumClients)
+		: World(InWorld)
+		, NetDriver(nullptr)
+	{
+		FURL URL;
+		UClass* ConnectionClass = FindObject<UClass>(ANY_PACKAGE, TEXT("SimulatedClientNetConnection"));
+		if (ConnectionClass == nullptr || !World->Listen(URL))
+		{
+			return;
+		}
+		NetDriver = World->GetNetDriver();
+		NetDriver->UnregisterTickEvents(World);
+
+		for (int32 Index = 0; Index < NumClients; ++Index)
+		{
+			UNetConnection* Connection = NewObject<UNetConnection>(GetTransientPackage(), ConnectionClass);
+			// Fast enough to never saturate, bytes show what game wants to send
+			Connection->InitConnection(NetDriver, USOCK_Open, URL, 100000000);
+			Connection->InitSendBuffer();
+			Connection->SetClientLoginState(EClientLoginState::Welcomed);
+			Connection->ClientWorldPackageName = World->GetOutermost()->GetFName();
+			NetDriver->AddClientConnection(Connection);
+
+			APlayerController* PlayerController = World->SpawnActor<APlayerController>();
+			PlayerController->Player = Connection;
+			PlayerController->NetConnection = Connection;
+			Connection->PlayerController = PlayerController;
+			Connection->OwningActor = PlayerController;
+			Connections.Add(Connection);
+		}
+	}
+
+	~FTEST_NetTestSession()
+	{
+		if (NetDriver != nullptr)
+		{
+			GEngine->ShutdownWorldNetDriver(World);
+		}
+	}
+
+	bool IsListening() const { return NetDriver != nullptr && Connections.Num() > 0; }
+
+	int32 NumClients() const { return Connections.Num(); }
+
+	UNetConnection* GetConnection(int32 Index) const { return Connections[Index]; }
+
+	APlayerController* GetPlayerController(int32 Index) const { return Connections[Index]->PlayerController; }
+
+	// Move view of client, relevancy and cull distance are tested from here
+	void SetViewLocation(int32 Index, const FVector& Location)
+	{
+		GetPlayerController(Index)->SetActorLocation(Location);
+	}
+
+	// Receive, replicate and send, call after world tick, returns seconds spent replicating
+	double Tick(float DeltaTime)
+	{
+		NetDriver->TickDispatch(DeltaTime);
+		// Clients never answer, keep them from timing out
+		for (UNetConnection* Connection : Connections)
+		{
+			Connection->LastReceiveTime = NetDriver->Time;
+			Connection->LastReceiveRealtime = FPlatformTime::Seconds();
+		}
+		const double StartTime = FPlatformTime::Seconds();
+		NetDriver->TickFlush(DeltaTime);
+		const double FlushTime = FPlatformTime::Seconds() - StartTime;
+		NetDriver->PostTickFlush();
+		return FlushTime;
+	}
+
+	// Bytes sent to one client since session start
+	int64 GetOutBytes(int32 Index) const { return Connections[Index]->OutTotalBytes; }
+
+	// Bytes sent to all clients since session start
+	int64 GetOutBytes() const
+	{
+		int64 Bytes = 0;
+		for (const UNetConnection* Connection : Connections)
+		{
+			Bytes += Connection->OutTotalBytes;
+		}
+		return Bytes;
+	}
+
+private:
+	UWorld* World;
+	UNetDriver* NetDriver;
+	TArray<UNetConnection*> Connections;
+};
+
+#endif
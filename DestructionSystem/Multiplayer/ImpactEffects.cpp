@@ -0,0 +1,104 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TEST_ImpactEffects.h"
+#include "Kismet/GameplayStatics.h"
+#include "Particles/ParticleSystemComponent.h"
+#include "TEST_PlayerViews.h"
+#include "Engine/World.h"
+
+DECLARE_STATS_GROUP(TEXT("TEST Impact Effects"), STATGROUP_TESTImpactEffects, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Effects requested"), STAT_TESTEffectsRequested, STATGROUP_TESTImpactEffects);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Effects spawned"), STAT_TESTEffectsSpawned, STATGROUP_TESTImpactEffects);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Effects culled by distance"), STAT_TESTEffectsCulled, STATGROUP_TESTImpactEffects);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Effects over limit"), STAT_TESTEffectsOverLimit, STATGROUP_TESTImpactEffects);
+
+void UTEST_ImpactEffects::Deinitialize()
+{
+	ActiveEffects.Empty();
+	Super::Deinitialize();
+}
+
+bool UTEST_ImpactEffects::SpawnEmitter(UParticleSystem* Template, const FVector& Location, const FRotator& Rotation)
+{
+	if (Template == nullptr)
+	{
+		return false;
+	}
+	INC_DWORD_STAT(STAT_TESTEffectsRequested);
+	if (!ShouldSpawnAt(Location))
+	{
+		return false;
+	}
+	if (!HasFreeSlot(Template))
+	{
+		INC_DWORD_STAT(STAT_TESTEffectsOverLimit);
+		return false;
+	}
+
+	// Component goes back to world pool when finished
+	UParticleSystemComponent* Component = UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), Template, Location, Rotation, true, EPSCPoolMethod::AutoRelease);
+	if (Component == nullptr)
+	{
+		return false;
+	}
+	ActiveEffects.FindOrAdd(Template).Components.Add(Component);
+	INC_DWORD_STAT(STAT_TESTEffectsSpawned);
+	return true;
+}
+
+bool UTEST_ImpactEffects::PlaySound(USoundBase* Sound, const FVector& Location)
+{
+	if (Sound == nullptr)
+	{
+		return false;
+	}
+	INC_DWORD_STAT(STAT_TESTEffectsRequested);
+	if (!ShouldSpawnAt(Location))
+	{
+		return false;
+	}
+	// Sound concurrency is limited by sound concurrency settings
+	UGameplayStatics::PlaySoundAtLocation(GetWorld(), Sound, Location);
+	INC_DWORD_STAT(STAT_TESTEffectsSpawned);
+	return true;
+}
+
+bool UTEST_ImpactEffects::ShouldSpawnAt(const FVector& Location) const
+{
+	UWorld* World = GetWorld();
+	if (World->GetNetMode() == NM_DedicatedServer)
+	{
+		return false;
+	}
+
+	// Only local players see effects, remote views do not matter
+	FTEST_ViewLocations ViewLocations;
+	FTEST_PlayerViews::Gather(World, ViewLocations, true);
+	if (ViewLocations.Num() == 0)
+	{
+		return true;
+	}
+	if (FTEST_PlayerViews::GetClosestDistanceSquared(Location, ViewLocations) <= FMath::Square(MaxEffectDistance))
+	{
+		return true;
+	}
+	INC_DWORD_STAT(STAT_TESTEffectsCulled);
+	return false;
+}
+
+bool UTEST_ImpactEffects::HasFreeSlot(UParticleSystem* Template)
+{
+	FTEST_ActiveEffects* Effects = ActiveEffects.Find(Template);
+	if (Effects == nullptr)
+	{
+		return true;
+	}
+
+	// Pooled component can already play other template
+	Effects->Components.RemoveAllSwap([Template](const TWeakObjectPtr<UParticleSystemComponent>& Component)
+	{
+		return !Component.IsValid() || !Component->IsActive() || Component->Template != Template;
+	});
+	return Effects->Components.Num() < MaxConcurrentPerTemplate;
+}
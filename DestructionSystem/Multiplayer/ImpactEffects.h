@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TEST_ImpactEffects.generated.h"
+
+class UParticleSystem;
+class UParticleSystemComponent;
+class USoundBase;
+
+// Running emitters of one template
+USTRUCT()
+struct FTEST_ActiveEffects
+{
+	GENERATED_BODY()
+
+	TArray<TWeakObjectPtr<UParticleSystemComponent>> Components;
+};
+
+/**
+ * Single place for cosmetic impact and break effects. Nothing is
+ * spawned on dedicated server, effects far from local players are
+ * skipped and every particle template has limit of running emitters.
+ * Emitters come from world particle component pool
+ */
+UCLASS(config=Game)
+class TEST_API UTEST_ImpactEffects : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	// Spawn emitter if it passes culling and limits, returns true if spawned
+	bool SpawnEmitter(UParticleSystem* Template, const FVector& Location, const FRotator& Rotation = FRotator::ZeroRotator);
+
+	// Play sound if it passes culling, returns true if played
+	bool PlaySound(USoundBase* Sound, const FVector& Location);
+
+	// Effects further from every local player are skipped
+	UPROPERTY(config)
+	float MaxEffectDistance = 8000.f;
+
+	// Running emitters of one template, new ones are skipped above it
+	UPROPERTY(config)
+	int32 MaxConcurrentPerTemplate = 8;
+
+private:
+	// False on dedicated server and for effects far from local players
+	bool ShouldSpawnAt(const FVector& Location) const;
+
+	// Forget finished emitters and check limit of template
+	bool HasFreeSlot(UParticleSystem* Template);
+
+	UPROPERTY(Transient)
+	TMap<UParticleSystem*, FTEST_ActiveEffects> ActiveEffects;
+};
@@ -0,0 +1,254 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TEST_LagCompensation.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/GameStateBase.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/SphereComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "Engine/World.h"
+
+DECLARE_STATS_GROUP(TEXT("TEST Lag Compensation"), STATGROUP_TESTLagCompensation, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Record snapshot"), STAT_TESTRecordSnapshot, STATGROUP_TESTLagCompensation);
+DECLARE_CYCLE_STAT(TEXT("Rewind and test"), STAT_TESTRewindAndTest, STATGROUP_TESTLagCompensation);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Hitbox histories"), STAT_TESTHitboxHistories, STATGROUP_TESTLagCompensation);
+DECLARE_MEMORY_STAT(TEXT("Hitbox history memory"), STAT_TESTHitboxHistoryMemory, STATGROUP_TESTLagCompensation);
+
+void UTEST_LagCompensation::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	// Histories are big, allocate once for expected player count
+	Histories.Reserve(ExpectedCharacters);
+	INC_MEMORY_STAT_BY(STAT_TESTHitboxHistoryMemory, Histories.GetAllocatedSize());
+}
+
+void UTEST_LagCompensation::Deinitialize()
+{
+	DEC_DWORD_STAT_BY(STAT_TESTHitboxHistories, Histories.Num());
+	DEC_MEMORY_STAT_BY(STAT_TESTHitboxHistoryMemory, Histories.GetAllocatedSize());
+	Histories.Empty();
+	Super::Deinitialize();
+}
+
+void UTEST_LagCompensation::Register(ACharacter* Character)
+{
+	if (Histories.ContainsByPredicate([Character](const FTEST_HitboxHistory& History) { return History.Character == Character; }))
+	{
+		return;
+	}
+	DEC_MEMORY_STAT_BY(STAT_TESTHitboxHistoryMemory, Histories.GetAllocatedSize());
+	FTEST_HitboxHistory& History = Histories.AddDefaulted_GetRef();
+	INC_MEMORY_STAT_BY(STAT_TESTHitboxHistoryMemory, Histories.GetAllocatedSize());
+	History.Character = Character;
+	History.Radius = Character->GetCapsuleComponent()->GetScaledCapsuleRadius();
+	INC_DWORD_STAT(STAT_TESTHitboxHistories);
+}
+
+void UTEST_LagCompensation::Unregister(ACharacter* Character)
+{
+	// Rings share indices, order of histories does not matter
+	const int32 Index = Histories.IndexOfByPredicate([Character](const FTEST_HitboxHistory& History) { return History.Character == Character; });
+	if (Index != INDEX_NONE)
+	{
+		Histories.RemoveAtSwap(Index, 1, false);
+		DEC_DWORD_STAT(STAT_TESTHitboxHistories);
+	}
+}
+
+float UTEST_LagCompensation::GetServerTime() const
+{
+	UWorld* World = GetWorld();
+	const AGameStateBase* GameState = World->GetGameState();
+	return GameState != nullptr ? GameState->GetServerWorldTimeSeconds() : World->GetTimeSeconds();
+}
+
+void UTEST_LagCompensation::Tick(float DeltaTime)
+{
+	const float Now = GetServerTime();
+	if (SampleRate <= 0.f || Now - LastRecordTime >= 1.f / SampleRate)
+	{
+		RecordSnapshot(Now);
+		LastRecordTime = Now;
+	}
+}
+
+void UTEST_LagCompensation::RecordSnapshot(float Time)
+{
+	SCOPE_CYCLE_COUNTER(STAT_TESTRecordSnapshot);
+
+	for (FTEST_HitboxHistory& History : Histories)
+	{
+		const ACharacter* Character = History.Character.Get();
+		if (Character == nullptr)
+		{
+			History.NumRecorded = 0;
+			continue;
+		}
+		const UCapsuleComponent* Capsule = Character->GetCapsuleComponent();
+		FTEST_HitboxSnapshot& Snapshot = History.Snapshots[Head];
+		Snapshot.Location = Capsule->GetComponentLocation();
+		// Crouching changes capsule height
+		Snapshot.HalfHeight = Capsule->GetScaledCapsuleHalfHeight();
+		History.Radius = Capsule->GetScaledCapsuleRadius();
+		History.NumRecorded = FMath::Min(History.NumRecorded + 1, FTEST_HitboxHistory::HistorySize);
+	}
+	SnapshotTimes[Head] = Time;
+	Head = (Head + 1) % FTEST_HitboxHistory::HistorySize;
+	NumSnapshots = FMath::Min(NumSnapshots + 1, FTEST_HitboxHistory::HistorySize);
+}
+
+int32 UTEST_LagCompensation::GetRingIndex(int32 LogicalIndex) const
+{
+	return (Head - NumSnapshots + LogicalIndex + FTEST_HitboxHistory::HistorySize) % FTEST_HitboxHistory::HistorySize;
+}
+
+bool UTEST_LagCompensation::RewindAndTest(const FVector& Start, const FVector& End, float Time, const AActor* IgnoreActor, FHitResult& OutHit, float ShotRadius) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_TESTRewindAndTest);
+
+	const FVector Segment = End - Start;
+	const float SegmentLength = Segment.Size();
+	if (NumSnapshots == 0 || SegmentLength <= KINDA_SMALL_NUMBER)
+	{
+		return false;
+	}
+	const FVector Direction = Segment / SegmentLength;
+
+	// Find snapshots around Time, times grow with logical index
+	int32 Older = 0;
+	int32 Newer = NumSnapshots - 1;
+	if (Time <= SnapshotTimes[GetRingIndex(Older)])
+	{
+		Newer = Older;
+	}
+	else if (Time >= SnapshotTimes[GetRingIndex(Newer)])
+	{
+		Older = Newer;
+	}
+	else
+	{
+		while (Newer - Older > 1)
+		{
+			const int32 Middle = (Older + Newer) / 2;
+			if (SnapshotTimes[GetRingIndex(Middle)] <= Time)
+			{
+				Older = Middle;
+			}
+			else
+			{
+				Newer = Middle;
+			}
+		}
+	}
+
+	float ClosestDistance = MAX_flt;
+	for (const FTEST_HitboxHistory& History : Histories)
+	{
+		ACharacter* Character = History.Character.Get();
+		if (Character == nullptr || Character == IgnoreActor || History.NumRecorded == 0)
+		{
+			continue;
+		}
+
+		// Character registered later than Time is tested at first snapshot
+		const int32 FirstValid = NumSnapshots - History.NumRecorded;
+		const int32 HistoryOlder = FMath::Max(Older, FirstValid);
+		const int32 HistoryNewer = FMath::Max(Newer, FirstValid);
+		const int32 OlderIndex = GetRingIndex(HistoryOlder);
+		const int32 NewerIndex = GetRingIndex(HistoryNewer);
+		float Alpha = 0.f;
+		if (HistoryOlder != HistoryNewer)
+		{
+			Alpha = (Time - SnapshotTimes[OlderIndex]) / (SnapshotTimes[NewerIndex] - SnapshotTimes[OlderIndex]);
+		}
+		const FTEST_HitboxSnapshot& OlderSnapshot = History.Snapshots[OlderIndex];
+		const FTEST_HitboxSnapshot& NewerSnapshot = History.Snapshots[NewerIndex];
+		const FVector Center = FMath::Lerp(OlderSnapshot.Location, NewerSnapshot.Location, Alpha);
+		const float HalfHeight = FMath::Lerp(OlderSnapshot.HalfHeight, NewerSnapshot.HalfHeight, Alpha);
+		// Sphere moving along segment hits capsule grown by its radius
+		const float Radius = History.Radius + ShotRadius;
+
+		// Cheap reject with sphere around whole capsule
+		if (FMath::PointDistToSegmentSquared(Center, Start, End) > FMath::Square(HalfHeight + ShotRadius))
+		{
+			continue;
+		}
+
+		// Capsule is segment along Z with radius
+		const FVector AxisOffset(0.f, 0.f, FMath::Max(HalfHeight - History.Radius, 0.f));
+		FVector OnShot;
+		FVector OnAxis;
+		FMath::SegmentDistToSegmentSafe(Start, End, Center - AxisOffset, Center + AxisOffset, OnShot, OnAxis);
+		const float DistanceSquared = FVector::DistSquared(OnShot, OnAxis);
+		if (DistanceSquared > FMath::Square(Radius))
+		{
+			continue;
+		}
+
+		// Step back from closest point to capsule surface
+		const float Penetration = FMath::Sqrt(FMath::Square(Radius) - DistanceSquared);
+		const float HitDistance = FMath::Max(FVector::Dist(Start, OnShot) - Penetration, 0.f);
+		if (HitDistance >= ClosestDistance)
+		{
+			continue;
+		}
+		ClosestDistance = HitDistance;
+
+		const FVector HitLocation = Start + Direction * HitDistance;
+		OutHit = FHitResult(Character, Character->GetCapsuleComponent(), HitLocation, (HitLocation - OnAxis).GetSafeNormal());
+		OutHit.ImpactPoint = HitLocation - OutHit.ImpactNormal * ShotRadius;
+		OutHit.TraceStart = Start;
+		OutHit.TraceEnd = End;
+		OutHit.Time = HitDistance / SegmentLength;
+		OutHit.Distance = HitDistance;
+		OutHit.bBlockingHit = true;
+	}
+	return ClosestDistance < MAX_flt;
+}
+
+bool UTEST_LagCompensation::SweepRewound(const FVector& Start, const FVector& End, const USphereComponent* Collision, float RewindTime, const AActor* Shooter, FHitResult& OutHit) const
+{
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(TESTSweepRewound), false, Shooter);
+	QueryParams.AddIgnoredActor(Collision->GetOwner());
+
+	// Same channel and responses as projectile profile, but characters
+	// are where they are now, rewound capsules are tested instead
+	ECollisionChannel Channel = Collision->GetCollisionObjectType();
+	FCollisionResponseParams ResponseParams(Collision->GetCollisionResponseToChannels());
+	FCollisionResponseTemplate Profile;
+	if (UCollisionProfile::Get()->GetProfileTemplate(Collision->GetCollisionProfileName(), Profile))
+	{
+		Channel = Profile.ObjectType;
+		ResponseParams.CollisionResponse = Profile.ResponseToChannels;
+	}
+	ResponseParams.CollisionResponse.SetResponse(ECC_Pawn, ECR_Ignore);
+
+	const float ShotRadius = Collision->GetUnscaledSphereRadius();
+	bool bHit = GetWorld()->SweepSingleByChannel(OutHit, Start, End, FQuat::Identity, Channel, FCollisionShape::MakeSphere(ShotRadius), QueryParams, ResponseParams);
+
+	// Characters count only up to world hit
+	FHitResult RewindHit;
+	if (RewindAndTest(Start, bHit ? OutHit.Location : End, RewindTime, Shooter, RewindHit, ShotRadius))
+	{
+		OutHit = RewindHit;
+		bHit = true;
+	}
+	return bHit;
+}
+
+ETickableTickType UTEST_LagCompensation::GetTickableTickType() const
+{
+	// Default object must not tick
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+bool UTEST_LagCompensation::IsTickable() const
+{
+	return Histories.Num() > 0;
+}
+
+TStatId UTEST_LagCompensation::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTEST_LagCompensation, STATGROUP_Tickables);
+}
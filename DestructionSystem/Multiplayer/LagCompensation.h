@@ -0,0 +1,110 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "TEST_LagCompensation.generated.h"
+
+class ACharacter;
+
+// Capsule of one character at one recorded time
+struct FTEST_HitboxSnapshot
+{
+	FVector Location;
+	float HalfHeight;
+};
+
+// Recent capsules of one character, fixed size ring indexed
+// the same way as UTEST_LagCompensation::SnapshotTimes
+struct FTEST_HitboxHistory
+{
+	static constexpr int32 HistorySize = 64;
+
+	TWeakObjectPtr<ACharacter> Character;
+
+	float Radius = 0.f;
+
+	// Snapshots recorded since character was registered
+	int32 NumRecorded = 0;
+
+	FTEST_HitboxSnapshot Snapshots[HistorySize];
+};
+
+/**
+ * Server side history of character capsules for validating shots
+ * of lagging clients. Capsules of all registered characters are
+ * recorded at fixed rate into fixed size rings, nothing is allocated
+ * after registration. RewindAndTest moves shot back to time seen by
+ * client and tests it against interpolated capsules analytically,
+ * without physics scene
+ */
+UCLASS(config=Game)
+class TEST_API UTEST_LagCompensation : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// Called by characters on server in BeginPlay and EndPlay
+	void Register(ACharacter* Character);
+	void Unregister(ACharacter* Character);
+
+	// Test segment, or sphere of ShotRadius moving along it, against capsules
+	// as they were at Time, OutHit is closest hit to Start. Time is clamped
+	// to recorded history
+	bool RewindAndTest(const FVector& Start, const FVector& End, float Time, const AActor* IgnoreActor, FHitResult& OutHit, float ShotRadius = 0.f) const;
+
+	// Sweep projectile collision from Start to End for shot fired at
+	// RewindTime: world without pawns as it is now and characters rewound.
+	// Shooter and owner of Collision are ignored, OutHit is closest hit
+	bool SweepRewound(const FVector& Start, const FVector& End, const class USphereComponent* Collision, float RewindTime, const AActor* Shooter, FHitResult& OutHit) const;
+
+	// Time used for recording, clients send the same time with shot
+	float GetServerTime() const;
+
+	// How far back server accepts client time, longer is clamped
+	float ClampRewindTime(float RewindTime) const { return FMath::Clamp(RewindTime, 0.f, MaxRewindTime); }
+
+	// Snapshots per second, history covers HistorySize / SampleRate seconds
+	UPROPERTY(config)
+	float SampleRate = 60.f;
+
+	// Longest accepted rewind
+	UPROPERTY(config)
+	float MaxRewindTime = 0.25f;
+
+	// Histories allocated up front
+	UPROPERTY(config)
+	int32 ExpectedCharacters = 100;
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+	// End of FTickableGameObject interface
+
+private:
+	// Store capsules of all characters at current time
+	void RecordSnapshot(float Time);
+
+	// Ring index of snapshot, 0 is oldest of NumSnapshots
+	int32 GetRingIndex(int32 LogicalIndex) const;
+
+	TArray<FTEST_HitboxHistory> Histories;
+
+	// Record time of every ring entry, shared by all histories
+	float SnapshotTimes[FTEST_HitboxHistory::HistorySize];
+
+	// Next ring entry to write
+	int32 Head = 0;
+
+	int32 NumSnapshots = 0;
+
+	float LastRecordTime = -MAX_flt;
+};
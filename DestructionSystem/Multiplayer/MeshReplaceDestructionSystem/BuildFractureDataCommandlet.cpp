@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TEST_BuildFractureDataCommandlet.h"
+#include "TEST_FractureData.h"
+#include "TEST_Destructable.h"
+#include "Engine/BlueprintGeneratedClass.h"
+#include "Misc/PackageName.h"
+#include "UObject/Package.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogTESTFractureData, Log, All);
+
+UTEST_BuildFractureDataCommandlet::UTEST_BuildFractureDataCommandlet()
+{
+	IsClient = false;
+	IsEditor = true;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+#if WITH_EDITOR
+namespace TESTFractureData
+{
+	bool SavePackage(UPackage* Package, UObject* Asset)
+	{
+		const FString Filename = FPackageName::LongPackageNameToFilename(Package->GetName(), FPackageName::GetAssetPackageExtension());
+		return UPackage::SavePackage(Package, Asset, RF_Public | RF_Standalone, *Filename);
+	}
+}
+#endif
+
+int32 UTEST_BuildFractureDataCommandlet::Main(const FString& Params)
+{
+#if WITH_EDITOR
+	FString ClassList;
+	if (!FParse::Value(*Params, TEXT("Classes="), ClassList, false))
+	{
+		UE_LOG(LogTESTFractureData, Error, TEXT("Missing -Classes=/Game/Path.BP_C,..."));
+		return 1;
+	}
+	FString OutputPath = TEXT("/Game/Fracture");
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+	const bool bAssign = FParse::Param(*Params, TEXT("Assign"));
+
+	TArray<FString> ClassPaths;
+	ClassList.ParseIntoArray(ClassPaths, TEXT(","));
+
+	int32 Errors = 0;
+	for (const FString& ClassPath : ClassPaths)
+	{
+		UBlueprintGeneratedClass* Class = Cast<UBlueprintGeneratedClass>(LoadClass<ATEST_Destructable>(nullptr, *ClassPath));
+		if (Class == nullptr || Class->SimpleConstructionScript == nullptr)
+		{
+			UE_LOG(LogTESTFractureData, Error, TEXT("%s is not destructable Blueprint"), *ClassPath);
+			++Errors;
+			continue;
+		}
+		ATEST_Destructable* Defaults = Class->GetDefaultObject<ATEST_Destructable>();
+
+		const FString AssetName = FString::Printf(TEXT("FD_%s"), *Class->GetName().LeftChop(2));
+		UPackage* Package = CreatePackage(nullptr, *(OutputPath / AssetName));
+		UTEST_FractureData* Data = NewObject<UTEST_FractureData>(Package, *AssetName, RF_Public | RF_Standalone);
+		Data->BuildFromParts(Class);
+
+		if (!TESTFractureData::SavePackage(Package, Data))
+		{
+			UE_LOG(LogTESTFractureData, Error, TEXT("Failed to save %s"), *Package->GetName());
+			++Errors;
+			continue;
+		}
+		UE_LOG(LogTESTFractureData, Display, TEXT("%s: %d pieces saved to %s"), *ClassPath, Data->Pieces.Num(), *Package->GetName());
+
+		if (bAssign)
+		{
+			Defaults->FractureData = Data;
+			UPackage* BlueprintPackage = Class->GetOutermost();
+			BlueprintPackage->MarkPackageDirty();
+			if (!TESTFractureData::SavePackage(BlueprintPackage, nullptr))
+			{
+				UE_LOG(LogTESTFractureData, Error, TEXT("Failed to save %s"), *BlueprintPackage->GetName());
+				++Errors;
+			}
+		}
+	}
+	return Errors == 0 ? 0 : 1;
+#else
+	return 1;
+#endif
+}
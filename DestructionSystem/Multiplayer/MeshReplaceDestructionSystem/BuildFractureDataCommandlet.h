@@ -0,0 +1,24 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "TEST_BuildFractureDataCommandlet.generated.h"
+
+/**
+ * Builds UTEST_FractureData from "part" components added in destructable Blueprints.
+ * Runs headless, e.g.:
+ * UE4Editor-Cmd TEST -run=TEST_BuildFractureData -Classes=/Game/BP_Crate.BP_Crate_C -Output=/Game/Fracture -Assign
+ * -Assign sets FractureData on Blueprint defaults and saves Blueprint
+ */
+UCLASS()
+class TEST_API UTEST_BuildFractureDataCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UTEST_BuildFractureDataCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,290 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TEST_DebrisPool.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/World.h"
+#include "TimerManager.h"
+#include "TEST_PlayerViews.h"
+#include "Algo/BinarySearch.h"
+
+DECLARE_STATS_GROUP(TEXT("TEST Debris"), STATGROUP_TESTDebris, STATCAT_Advanced);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Debris components"), STAT_TESTDebrisComponents, STATGROUP_TESTDebris);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Active debris"), STAT_TESTActiveDebris, STATGROUP_TESTDebris);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Simulating debris bodies"), STAT_TESTSimulatingDebris, STATGROUP_TESTDebris);
+DECLARE_CYCLE_STAT(TEXT("Update debris"), STAT_TESTUpdateDebris, STATGROUP_TESTDebris);
+
+void UTEST_DebrisPool::Deinitialize()
+{
+	DEC_DWORD_STAT_BY(STAT_TESTDebrisComponents, FreeComponents.Num() + ActiveDebris.Num());
+	DEC_DWORD_STAT_BY(STAT_TESTActiveDebris, ActiveDebris.Num());
+	DEC_DWORD_STAT_BY(STAT_TESTSimulatingDebris, NumSimulating);
+	NumSimulating = 0;
+	FreeComponents.Empty();
+	ActiveDebris.Empty();
+	SimulatingQueue.Empty();
+	SimulatingQueueHead = 0;
+	PoolActor = nullptr;
+	Super::Deinitialize();
+}
+
+void UTEST_DebrisPool::SpawnDebris(const TArray<FTEST_DebrisPiece>& Pieces, const FTransform& OwnerTransform, const FVector& Impulse, float LifeTime, int32 Seed)
+{
+	if (!ShouldSpawnDebris(GetWorld()->GetNetMode()))
+	{
+		return;
+	}
+
+	const float ExpireTime = GetWorld()->GetTimeSeconds() + LifeTime;
+	const float ImpulseSize = Impulse.Size();
+	FRandomStream RandomStream(Seed);
+
+	// Nobody sees far debris move, it is only placed
+	FTEST_ViewLocations ViewLocations;
+	FTEST_PlayerViews::Gather(GetWorld(), ViewLocations);
+	const bool bSimulate = IsNearAnyView(OwnerTransform.GetLocation(), ViewLocations);
+	if (bSimulate)
+	{
+		EvictSimulatingDebris(FMath::Min(Pieces.Num(), MaxSimulatingBodies));
+	}
+
+	for (const FTEST_DebrisPiece& Piece : Pieces)
+	{
+		// Taken for every piece so frozen pieces do not shift the sequence
+		const FVector ImpulseVariationDirection = RandomStream.VRand();
+		UStaticMeshComponent* Comp = AcquireComponent();
+		Comp->SetStaticMesh(Piece.Mesh);
+		for (int32 MaterialIndex = 0; MaterialIndex < Piece.Materials.Num(); ++MaterialIndex)
+		{
+			Comp->SetMaterial(MaterialIndex, Piece.Materials[MaterialIndex]);
+		}
+		Comp->SetWorldTransform(Piece.RelativeTransform * OwnerTransform, false, nullptr, ETeleportType::ResetPhysics);
+		Comp->SetHiddenInGame(false);
+		Comp->SetCollisionEnabled(ECollisionEnabled::PhysicsOnly);
+
+		FTEST_ActiveDebris& Debris = ActiveDebris.AddDefaulted_GetRef();
+		Debris.Component = Comp;
+		Debris.ExpireTime = ExpireTime;
+		Debris.SpawnOrder = NextSpawnOrder++;
+		INC_DWORD_STAT(STAT_TESTActiveDebris);
+
+		if (bSimulate && NumSimulating < MaxSimulatingBodies)
+		{
+			Comp->SetMassOverrideInKg(NAME_None, Piece.Mass, Piece.Mass > 0.f);
+			Comp->SetSimulatePhysics(true);
+
+			// Precomputed direction throws pieces away from center
+			FVector PieceImpulse = Impulse + ImpulseVariationDirection * ImpulseSize * ImpulseVariation;
+			if (!Piece.ImpulseDirection.IsNearlyZero())
+			{
+				PieceImpulse += OwnerTransform.TransformVectorNoScale(Piece.ImpulseDirection) * ImpulseSize;
+			}
+			Comp->AddImpulse(PieceImpulse, NAME_None, true); // Fire impulse
+
+			Debris.bSimulating = true;
+			SimulatingQueue.Add(Debris.SpawnOrder);
+			++NumSimulating;
+			INC_DWORD_STAT(STAT_TESTSimulatingDebris);
+		}
+	}
+
+	FTimerManager& TimerManager = GetWorld()->GetTimerManager();
+	if (!TimerManager.IsTimerActive(UpdateTimer))
+	{
+		TimerManager.SetTimer(UpdateTimer, this, &UTEST_DebrisPool::UpdateDebris, UpdateInterval, true);
+	}
+}
+
+bool UTEST_DebrisPool::ShouldSpawnDebris(ENetMode NetMode) const
+{
+	// Nothing renders debris on dedicated server and it does not affect gameplay
+	return bSimulateDebrisOnServer || NetMode != NM_DedicatedServer;
+}
+
+UStaticMeshComponent* UTEST_DebrisPool::AcquireComponent()
+{
+	if (FreeComponents.Num() == 0)
+	{
+		// First use fills pool, later it grows by one
+		const int32 Count = PoolActor == nullptr ? FMath::Max(InitialPoolSize, 1) : 1;
+		for (int32 i = 0; i < Count; ++i)
+		{
+			FreeComponents.Add(CreateComponent());
+		}
+	}
+	return FreeComponents.Pop(false);
+}
+
+void UTEST_DebrisPool::ReleaseComponent(UStaticMeshComponent* Component)
+{
+	Component->SetSimulatePhysics(false);
+	Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Component->SetHiddenInGame(true);
+	Component->SetStaticMesh(nullptr);
+	Component->EmptyOverrideMaterials();
+	FreeComponents.Add(Component);
+}
+
+UStaticMeshComponent* UTEST_DebrisPool::CreateComponent()
+{
+	if (PoolActor == nullptr)
+	{
+		FActorSpawnParameters SpawnParameters;
+		SpawnParameters.ObjectFlags |= RF_Transient;
+		PoolActor = GetWorld()->SpawnActor<AActor>(SpawnParameters);
+		USceneComponent* Root = NewObject<USceneComponent>(PoolActor, TEXT("Root"));
+		PoolActor->SetRootComponent(Root);
+		Root->RegisterComponent();
+	}
+
+	// Parts are not attached, they live in world space
+	UStaticMeshComponent* Comp = NewObject<UStaticMeshComponent>(PoolActor);
+	Comp->SetMobility(EComponentMobility::Movable);
+	Comp->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Comp->SetWalkableSlopeOverride(FWalkableSlopeOverride(WalkableSlope_Unwalkable, 0.f));
+	Comp->CanCharacterStepUpOn = ECB_No;
+	Comp->SetCanEverAffectNavigation(false);
+	Comp->SetGenerateOverlapEvents(false);
+	Comp->SetHiddenInGame(true);
+	Comp->RegisterComponent();
+	INC_DWORD_STAT(STAT_TESTDebrisComponents);
+	return Comp;
+}
+
+void UTEST_DebrisPool::UpdateDebris()
+{
+	SCOPE_CYCLE_COUNTER(STAT_TESTUpdateDebris);
+
+	FTEST_ViewLocations ViewLocations;
+	FTEST_PlayerViews::Gather(GetWorld(), ViewLocations);
+
+	// Kept debris is moved down in place so array stays in spawn order
+	const float Now = GetWorld()->GetTimeSeconds();
+	int32 NumKept = 0;
+	for (int32 Index = 0; Index < ActiveDebris.Num(); ++Index)
+	{
+		FTEST_ActiveDebris& Debris = ActiveDebris[Index];
+		if (Debris.ExpireTime <= Now)
+		{
+			RetireDebris(Debris);
+			continue;
+		}
+		if (Debris.bSimulating)
+		{
+			// Resting piece stays where it landed, moving piece nobody
+			// is close to is hidden instead of stopping in the air
+			if (IsResting(Debris.Component))
+			{
+				FreezeDebris(Debris);
+			}
+			else if (!IsNearAnyView(Debris.Component->GetComponentLocation(), ViewLocations))
+			{
+				RetireDebris(Debris);
+				continue;
+			}
+		}
+		if (NumKept != Index)
+		{
+			ActiveDebris[NumKept] = Debris;
+		}
+		++NumKept;
+	}
+	ActiveDebris.SetNum(NumKept, false);
+
+	// Frozen and retired pieces leave stale entries, drop them from front
+	while (SimulatingQueueHead < SimulatingQueue.Num())
+	{
+		const int32 Index = FindDebris(SimulatingQueue[SimulatingQueueHead]);
+		if (Index != INDEX_NONE && ActiveDebris[Index].bSimulating)
+		{
+			break;
+		}
+		++SimulatingQueueHead;
+	}
+	CompactSimulatingQueue();
+
+	if (ActiveDebris.Num() == 0)
+	{
+		GetWorld()->GetTimerManager().ClearTimer(UpdateTimer);
+	}
+}
+
+bool UTEST_DebrisPool::IsResting(const UStaticMeshComponent* Component) const
+{
+	return !Component->RigidBodyIsAwake()
+		|| (Component->GetPhysicsLinearVelocity().SizeSquared() < FMath::Square(RestLinearSpeed)
+			&& Component->GetPhysicsAngularVelocityInDegrees().SizeSquared() < FMath::Square(RestAngularSpeed));
+}
+
+void UTEST_DebrisPool::FreezeDebris(FTEST_ActiveDebris& Debris)
+{
+	check(Debris.bSimulating);
+	Debris.Component->PutRigidBodyToSleep();
+	Debris.Component->SetSimulatePhysics(false);
+	Debris.bSimulating = false;
+	--NumSimulating;
+	DEC_DWORD_STAT(STAT_TESTSimulatingDebris);
+}
+
+void UTEST_DebrisPool::RetireDebris(FTEST_ActiveDebris& Debris)
+{
+	if (Debris.bSimulating)
+	{
+		Debris.bSimulating = false;
+		--NumSimulating;
+		DEC_DWORD_STAT(STAT_TESTSimulatingDebris);
+	}
+	ReleaseComponent(Debris.Component);
+	Debris.Component = nullptr;
+	DEC_DWORD_STAT(STAT_TESTActiveDebris);
+}
+
+void UTEST_DebrisPool::EvictSimulatingDebris(int32 NumNew)
+{
+	// Queue is in spawn order, oldest simulating piece is at its head
+	while (NumSimulating > 0 && NumSimulating + NumNew > MaxSimulatingBodies)
+	{
+		check(SimulatingQueueHead < SimulatingQueue.Num());
+		const int32 Index = FindDebris(SimulatingQueue[SimulatingQueueHead++]);
+		if (Index == INDEX_NONE || !ActiveDebris[Index].bSimulating)
+		{
+			continue;
+		}
+		FTEST_ActiveDebris& Oldest = ActiveDebris[Index];
+		if (IsResting(Oldest.Component))
+		{
+			FreezeDebris(Oldest);
+		}
+		else
+		{
+			RetireDebris(Oldest);
+			ActiveDebris.RemoveAt(Index, 1, false);
+		}
+	}
+	CompactSimulatingQueue();
+}
+
+int32 UTEST_DebrisPool::FindDebris(uint32 SpawnOrder) const
+{
+	return Algo::BinarySearchBy(ActiveDebris, SpawnOrder, &FTEST_ActiveDebris::SpawnOrder);
+}
+
+void UTEST_DebrisPool::CompactSimulatingQueue()
+{
+	if (NumSimulating == 0)
+	{
+		SimulatingQueue.Reset();
+		SimulatingQueueHead = 0;
+	}
+	else if (SimulatingQueueHead > SimulatingQueue.Num() / 2)
+	{
+		SimulatingQueue.RemoveAt(0, SimulatingQueueHead, false);
+		SimulatingQueueHead = 0;
+	}
+}
+
+bool UTEST_DebrisPool::IsNearAnyView(const FVector& Location, const FTEST_ViewLocations& ViewLocations) const
+{
+	// Without players (e.g. standalone tools) keep full simulation
+	return ViewLocations.Num() == 0 || FTEST_PlayerViews::GetClosestDistanceSquared(Location, ViewLocations) <= FMath::Square(SimulationDistance);
+}
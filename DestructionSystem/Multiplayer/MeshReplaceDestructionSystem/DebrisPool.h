@@ -0,0 +1,171 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TEST_PlayerViews.h"
+#include "TEST_DebrisPool.generated.h"
+
+class UStaticMesh;
+class UStaticMeshComponent;
+
+// One part of broken object
+USTRUCT(BlueprintType)
+struct FTEST_DebrisPiece
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debris")
+	UStaticMesh* Mesh = nullptr;
+
+	// Transform relative to destructable actor
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debris")
+	FTransform RelativeTransform;
+
+	// Materials overriden on part, empty uses mesh materials
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debris")
+	TArray<UMaterialInterface*> Materials;
+
+	// Mass in kg, 0 uses mass calculated by physics
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debris")
+	float Mass = 0.f;
+
+	// Direction in actor space added to break impulse, zero for none
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Debris")
+	FVector ImpulseDirection = FVector::ZeroVector;
+};
+
+// Debris piece in the world waiting for return to pool
+USTRUCT()
+struct FTEST_ActiveDebris
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	UStaticMeshComponent* Component = nullptr;
+
+	float ExpireTime = 0.f;
+
+	// Spawn order, active debris is sorted by it
+	uint32 SpawnOrder = 0;
+
+	bool bSimulating = false;
+};
+
+/**
+ * Global pool of debris mesh components. Destructables do not keep
+ * part components, pieces are taken from pool on break and returned
+ * after their life time
+ */
+UCLASS(config=Game)
+class TEST_API UTEST_DebrisPool : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	// Show pieces at owner transform and throw them with impulse,
+	// seed varies impulse of every piece the same way on all machines
+	void SpawnDebris(const TArray<FTEST_DebrisPiece>& Pieces, const FTransform& OwnerTransform, const FVector& Impulse, float LifeTime, int32 Seed);
+
+	// Debris is cosmetic, false on dedicated server unless bSimulateDebrisOnServer
+	bool ShouldSpawnDebris(ENetMode NetMode) const;
+
+	// Pieces in the world, simulating or not
+	int32 GetNumActiveDebris() const { return ActiveDebris.Num(); }
+
+	// Components owned by pool, free and active, same as "Debris components" stat
+	int32 GetNumDebrisComponents() const { return FreeComponents.Num() + ActiveDebris.Num(); }
+
+	// Components created on first use, pool grows when needed
+	UPROPERTY(config)
+	int32 InitialPoolSize = 64;
+
+	// Max debris bodies simulated at once, above it oldest pieces
+	// stop if they are resting or are hidden if they still move
+	UPROPERTY(config)
+	int32 MaxSimulatingBodies = 64;
+
+	// Debris further from every player view is not simulated,
+	// moving debris which gets further is hidden
+	UPROPERTY(config)
+	float SimulationDistance = 5000.f;
+
+	// Speed in cm/s below which piece is resting and becomes static
+	UPROPERTY(config)
+	float RestLinearSpeed = 5.f;
+
+	// Angular speed in deg/s below which piece is resting
+	UPROPERTY(config)
+	float RestAngularSpeed = 10.f;
+
+	// Part of impulse size added in random direction to every piece
+	UPROPERTY(config)
+	float ImpulseVariation = 0.25f;
+
+	// Debris is cosmetic, dedicated server does not spawn it by default
+	UPROPERTY(config)
+	bool bSimulateDebrisOnServer = false;
+
+	// How often simulating debris is checked
+	UPROPERTY(config)
+	float UpdateInterval = 0.25f;
+
+private:
+	// Take free component or create new one
+	UStaticMeshComponent* AcquireComponent();
+
+	// Hide component, disable physics and keep for next use
+	void ReleaseComponent(UStaticMeshComponent* Component);
+
+	UStaticMeshComponent* CreateComponent();
+
+	// Return expired debris, freeze resting debris and hide far
+	// moving debris, called by timer
+	void UpdateDebris();
+
+	bool IsResting(const UStaticMeshComponent* Component) const;
+
+	// Stop simulation and keep piece where it is
+	void FreezeDebris(FTEST_ActiveDebris& Debris);
+
+	// Return piece to pool, caller removes it from ActiveDebris
+	void RetireDebris(FTEST_ActiveDebris& Debris);
+
+	// Stop or hide oldest simulating pieces until there is room for new ones
+	void EvictSimulatingDebris(int32 NumNew);
+
+	// Index in ActiveDebris, INDEX_NONE if piece is gone
+	int32 FindDebris(uint32 SpawnOrder) const;
+
+	// Drop consumed head of SimulatingQueue
+	void CompactSimulatingQueue();
+
+	// True if location is within simulation distance of any player view
+	bool IsNearAnyView(const FVector& Location, const FTEST_ViewLocations& ViewLocations) const;
+
+	// Actor which owns all pooled components
+	UPROPERTY(Transient)
+	AActor* PoolActor;
+
+	UPROPERTY(Transient)
+	TArray<UStaticMeshComponent*> FreeComponents;
+
+	// Pieces in the world in spawn order
+	UPROPERTY(Transient)
+	TArray<FTEST_ActiveDebris> ActiveDebris;
+
+	// Spawn orders of simulating pieces, oldest first. Entries of pieces
+	// which stopped are skipped when they reach the head
+	TArray<uint32> SimulatingQueue;
+
+	int32 SimulatingQueueHead = 0;
+
+	FTimerHandle UpdateTimer;
+
+	int32 NumSimulating = 0;
+
+	uint32 NextSpawnOrder = 0;
+};
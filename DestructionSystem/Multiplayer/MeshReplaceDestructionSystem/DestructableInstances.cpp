@@ -0,0 +1,131 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TEST_DestructableInstances.h"
+#include "TEST_Destructable.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "Engine/World.h"
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Instanced destructables"), STAT_TESTInstancedDestructables, STATGROUP_Game);
+
+void UTEST_DestructableInstances::Deinitialize()
+{
+	for (const FTEST_DestructableInstanceGroup& Group : Groups)
+	{
+		DEC_DWORD_STAT_BY(STAT_TESTInstancedDestructables, Group.Owners.Num() - Group.FreeIndices.Num());
+	}
+	Groups.Empty();
+	InstancesActor = nullptr;
+	Super::Deinitialize();
+}
+
+bool UTEST_DestructableInstances::AddInstance(ATEST_Destructable* Destructable)
+{
+	UWorld* World = GetWorld();
+	// Nothing is drawn on dedicated server
+	if (World == nullptr || World->IsNetMode(NM_DedicatedServer))
+	{
+		return false;
+	}
+
+	UStaticMeshComponent* SolidMesh = Destructable->SolidMesh;
+	if (SolidMesh == nullptr || SolidMesh->GetStaticMesh() == nullptr || Destructable->InstanceComponent != nullptr)
+	{
+		return false;
+	}
+
+	FTEST_DestructableInstanceGroup& Group = FindOrAddGroup(SolidMesh->GetStaticMesh(), SolidMesh->GetMaterial(0), Destructable);
+	const FTransform& Transform = SolidMesh->GetComponentTransform();
+	int32 InstanceIndex;
+	if (Group.FreeIndices.Num() > 0)
+	{
+		InstanceIndex = Group.FreeIndices.Pop(false);
+		Group.Component->UpdateInstanceTransform(InstanceIndex, Transform, true, true, true);
+		Group.Owners[InstanceIndex] = Destructable;
+	}
+	else
+	{
+		InstanceIndex = Group.Component->AddInstanceWorldSpace(Transform);
+		check(InstanceIndex == Group.Owners.Num());
+		Group.Owners.Add(Destructable);
+	}
+
+	Destructable->InstanceComponent = Group.Component;
+	Destructable->InstanceIndex = InstanceIndex;
+	INC_DWORD_STAT(STAT_TESTInstancedDestructables);
+	return true;
+}
+
+void UTEST_DestructableInstances::RemoveInstance(ATEST_Destructable* Destructable)
+{
+	UHierarchicalInstancedStaticMeshComponent* Component = Destructable->InstanceComponent;
+	if (Component == nullptr)
+	{
+		return;
+	}
+	const int32 InstanceIndex = Destructable->InstanceIndex;
+	Destructable->InstanceComponent = nullptr;
+	Destructable->InstanceIndex = INDEX_NONE;
+
+	FTEST_DestructableInstanceGroup* Group = Groups.FindByPredicate([Component](const FTEST_DestructableInstanceGroup& Item) { return Item.Component == Component; });
+	if (Group == nullptr || !Group->Owners.IsValidIndex(InstanceIndex) || Group->Owners[InstanceIndex] != Destructable)
+	{
+		return;
+	}
+
+	// Hide instance by scale instead of removing, removing would change other indices
+	const FTransform HiddenTransform(FQuat::Identity, Destructable->GetActorLocation(), FVector::ZeroVector);
+	Component->UpdateInstanceTransform(InstanceIndex, HiddenTransform, true, true, true);
+	Group->Owners[InstanceIndex] = nullptr;
+	Group->FreeIndices.Add(InstanceIndex);
+	DEC_DWORD_STAT(STAT_TESTInstancedDestructables);
+}
+
+ATEST_Destructable* UTEST_DestructableInstances::GetInstanceOwner(const UHierarchicalInstancedStaticMeshComponent* Component, int32 InstanceIndex) const
+{
+	for (const FTEST_DestructableInstanceGroup& Group : Groups)
+	{
+		if (Group.Component == Component)
+		{
+			return Group.Owners.IsValidIndex(InstanceIndex) ? Group.Owners[InstanceIndex] : nullptr;
+		}
+	}
+	return nullptr;
+}
+
+FTEST_DestructableInstanceGroup& UTEST_DestructableInstances::FindOrAddGroup(UStaticMesh* Mesh, UMaterialInterface* Material, const ATEST_Destructable* Destructable)
+{
+	for (FTEST_DestructableInstanceGroup& Group : Groups)
+	{
+		if (Group.Component->GetStaticMesh() == Mesh && Group.Component->GetMaterial(0) == Material)
+		{
+			return Group;
+		}
+	}
+
+	if (InstancesActor == nullptr)
+	{
+		FActorSpawnParameters SpawnParameters;
+		SpawnParameters.ObjectFlags |= RF_Transient;
+		InstancesActor = GetWorld()->SpawnActor<AActor>(SpawnParameters);
+		USceneComponent* Root = NewObject<USceneComponent>(InstancesActor, TEXT("Root"));
+		InstancesActor->SetRootComponent(Root);
+		Root->RegisterComponent();
+	}
+
+	// Only drawing, collision stays on destructable mesh
+	UHierarchicalInstancedStaticMeshComponent* Component = NewObject<UHierarchicalInstancedStaticMeshComponent>(InstancesActor);
+	Component->SetMobility(EComponentMobility::Static);
+	Component->SetStaticMesh(Mesh);
+	Component->SetMaterial(0, Material);
+	Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Component->SetCanEverAffectNavigation(false);
+	Component->SetGenerateOverlapEvents(false);
+	Component->CastShadow = Destructable->SolidMesh->CastShadow;
+	Component->SetupAttachment(InstancesActor->GetRootComponent());
+	Component->RegisterComponent();
+
+	FTEST_DestructableInstanceGroup& Group = Groups.AddDefaulted_GetRef();
+	Group.Component = Component;
+	return Group;
+}
@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TEST_DestructableInstances.generated.h"
+
+class ATEST_Destructable;
+class UHierarchicalInstancedStaticMeshComponent;
+class UStaticMesh;
+
+// Instances of one mesh and material
+USTRUCT()
+struct FTEST_DestructableInstanceGroup
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	UHierarchicalInstancedStaticMeshComponent* Component = nullptr;
+
+	// Destructable drawn by every instance, null for free instance
+	UPROPERTY()
+	TArray<ATEST_Destructable*> Owners;
+
+	// Hidden instances ready to reuse, indices are never removed
+	// so indices stored in destructables stay valid
+	TArray<int32> FreeIndices;
+};
+
+/**
+ * Draws intact destructables sharing mesh as instances of one
+ * hierarchical instanced mesh. Destructable keeps its own mesh for
+ * collision and hits, mesh is shown again after damage or break
+ */
+UCLASS()
+class TEST_API UTEST_DestructableInstances : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	// Start drawing destructable as instance, returns false if
+	// instancing is not used in this world, e.g. on dedicated server
+	bool AddInstance(ATEST_Destructable* Destructable);
+
+	// Stop drawing destructable as instance
+	void RemoveInstance(ATEST_Destructable* Destructable);
+
+	// Destructable drawn by instance, null if instance is free
+	ATEST_Destructable* GetInstanceOwner(const UHierarchicalInstancedStaticMeshComponent* Component, int32 InstanceIndex) const;
+
+private:
+	FTEST_DestructableInstanceGroup& FindOrAddGroup(UStaticMesh* Mesh, UMaterialInterface* Material, const ATEST_Destructable* Destructable);
+
+	// Actor which owns all instanced components
+	UPROPERTY(Transient)
+	AActor* InstancesActor;
+
+	UPROPERTY(Transient)
+	TArray<FTEST_DestructableInstanceGroup> Groups;
+};
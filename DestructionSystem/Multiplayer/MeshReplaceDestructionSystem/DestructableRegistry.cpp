@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TEST_DestructableRegistry.h"
+#include "TEST_Destructable.h"
+
+DECLARE_CYCLE_STAT(TEXT("Destructable registry query"), STAT_TESTDestructableRegistryQuery, STATGROUP_Game);
+
+void UTEST_DestructableRegistry::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	Grid.SetCellSize(CellSize);
+}
+
+void UTEST_DestructableRegistry::Deinitialize()
+{
+	Grid.Empty();
+	Super::Deinitialize();
+}
+
+void UTEST_DestructableRegistry::Register(ATEST_Destructable* Destructable)
+{
+	Grid.Add(Destructable, Destructable->GetActorLocation());
+}
+
+void UTEST_DestructableRegistry::Unregister(ATEST_Destructable* Destructable)
+{
+	Grid.Remove(Destructable);
+}
+
+void UTEST_DestructableRegistry::GetDestructablesInRadius(const FVector& Origin, float Radius, TArray<ATEST_Destructable*>& OutDestructables) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_TESTDestructableRegistryQuery);
+
+	OutDestructables.Reset();
+	Grid.ForEachInRadius(Origin, Radius, [&OutDestructables](ATEST_Destructable* Destructable, const FVector& Location)
+	{
+		OutDestructables.Add(Destructable);
+	});
+}
@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TESTSpatialGrid.h"
+#include "TEST_DestructableRegistry.generated.h"
+
+class ATEST_Destructable;
+
+/**
+ * Keeps every intact destructable on server in uniform grid,
+ * area damage finds destructables without overlaps and traces
+ */
+UCLASS(config=Game)
+class TEST_API UTEST_DestructableRegistry : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// Called by destructables on BeginPlay, break and EndPlay.
+	// Destructables are static, location is stored once
+	void Register(ATEST_Destructable* Destructable);
+	void Unregister(ATEST_Destructable* Destructable);
+
+	// All registered destructables inside sphere
+	void GetDestructablesInRadius(const FVector& Origin, float Radius, TArray<ATEST_Destructable*>& OutDestructables) const;
+
+	int32 Num() const { return Grid.Num(); }
+
+	// Size of one grid cell
+	UPROPERTY(config)
+	float CellSize = 1000.f;
+
+private:
+	TTESTSpatialGrid<ATEST_Destructable*> Grid;
+};
@@ -0,0 +1,84 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TEST_DestructionScheduler.h"
+#include "TEST_Destructable.h"
+#include "TEST_DestructionStats.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+static TAutoConsoleVariable<float> CVarTESTBreakBudgetMs(
+	TEXT("TEST.Destruction.BreakBudgetMs"),
+	2.0f,
+	TEXT("Time in milliseconds per frame for breaking destructables.\n")
+	TEXT("At least one break is done every frame, 0 breaks everything at once"),
+	ECVF_Default);
+
+DECLARE_CYCLE_STAT(TEXT("Scheduled breaks"), STAT_TESTScheduledBreaks, STATGROUP_TESTDestruction);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pending breaks"), STAT_TESTPendingBreaks, STATGROUP_TESTDestruction);
+
+void UTEST_DestructionScheduler::Deinitialize()
+{
+	DEC_DWORD_STAT_BY(STAT_TESTPendingBreaks, PendingBreaks.Num());
+	PendingBreaks.Empty();
+	Super::Deinitialize();
+}
+
+void UTEST_DestructionScheduler::RequestBreak(ATEST_Destructable* Destructable)
+{
+	if (ViewLocationsFrame != GFrameCounter)
+	{
+		ViewLocationsFrame = GFrameCounter;
+		ViewLocations.Reset();
+		FTEST_PlayerViews::Gather(GetWorld(), ViewLocations);
+	}
+
+	FTEST_PendingBreak PendingBreak;
+	PendingBreak.Destructable = Destructable;
+	// Without players every break has the same priority
+	PendingBreak.DistanceSquared = ViewLocations.Num() > 0 ? FTEST_PlayerViews::GetClosestDistanceSquared(Destructable->GetActorLocation(), ViewLocations) : 0.f;
+	PendingBreaks.HeapPush(PendingBreak);
+	INC_DWORD_STAT(STAT_TESTPendingBreaks);
+}
+
+void UTEST_DestructionScheduler::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_TESTScheduledBreaks);
+
+	const float BudgetMs = CVarTESTBreakBudgetMs.GetValueOnGameThread();
+	const double EndTime = FPlatformTime::Seconds() + BudgetMs * 0.001;
+
+	int32 Processed = 0;
+	while (PendingBreaks.Num() > 0)
+	{
+		if (Processed > 0 && BudgetMs > 0.f && FPlatformTime::Seconds() >= EndTime)
+		{
+			break;
+		}
+		FTEST_PendingBreak PendingBreak;
+		PendingBreaks.HeapPop(PendingBreak, false);
+		TWeakObjectPtr<ATEST_Destructable> Destructable = PendingBreak.Destructable;
+		DEC_DWORD_STAT(STAT_TESTPendingBreaks);
+		if (Destructable.IsValid())
+		{
+			Destructable->ExecuteBreak();
+			++Processed;
+		}
+	}
+}
+
+ETickableTickType UTEST_DestructionScheduler::GetTickableTickType() const
+{
+	// Default object must not tick
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+bool UTEST_DestructionScheduler::IsTickable() const
+{
+	return PendingBreaks.Num() > 0;
+}
+
+TStatId UTEST_DestructionScheduler::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTEST_DestructionScheduler, STATGROUP_Tickables);
+}
@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "TEST_PlayerViews.h"
+#include "TEST_DestructionScheduler.generated.h"
+
+class ATEST_Destructable;
+
+// Break waiting for execution
+struct FTEST_PendingBreak
+{
+	TWeakObjectPtr<ATEST_Destructable> Destructable;
+
+	// Squared distance to closest player when break was requested
+	float DistanceSquared = 0.f;
+
+	// Closest break is on top of heap
+	bool operator<(const FTEST_PendingBreak& Other) const
+	{
+		return DistanceSquared < Other.DistanceSquared;
+	}
+};
+
+/**
+ * Spreads breaking of many destructables over several frames.
+ * Breaks closest to players are done first, every frame until
+ * budget from TEST.Destruction.BreakBudgetMs is used. Priority is
+ * set once on request, pending breaks are kept in a heap
+ */
+UCLASS()
+class TEST_API UTEST_DestructionScheduler : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	// Queue break, it is executed on this or one of next frames
+	void RequestBreak(ATEST_Destructable* Destructable);
+
+	int32 GetNumPendingBreaks() const { return PendingBreaks.Num(); }
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+	// End of FTickableGameObject interface
+
+private:
+	// Heap ordered by distance to closest player
+	TArray<FTEST_PendingBreak> PendingBreaks;
+
+	// Views gathered once per frame for all requests of that frame
+	FTEST_ViewLocations ViewLocations;
+
+	uint64 ViewLocationsFrame = 0;
+};
@@ -0,0 +1,9 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+// Stats of destruction subsystems, shown with "stat TESTDestruction"
+DECLARE_STATS_GROUP(TEXT("TEST Destruction"), STATGROUP_TESTDestruction, STATCAT_Advanced);
@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TEST_FractureData.h"
+#include "TEST_Destructable.h"
+#include "Engine/BlueprintGeneratedClass.h"
+#include "Engine/SimpleConstructionScript.h"
+#include "Engine/SCS_Node.h"
+#include "Engine/StaticMesh.h"
+#include "PhysicsEngine/BodySetup.h"
+
+#if WITH_EDITOR
+namespace TESTFractureData
+{
+	// Transform of node relative to actor, parents are walked up to native root
+	FTransform GetNodeTransform(USimpleConstructionScript* SCS, USCS_Node* Node)
+	{
+		FTransform Transform = FTransform::Identity;
+		while (Node != nullptr)
+		{
+			if (USceneComponent* Template = Cast<USceneComponent>(Node->ComponentTemplate))
+			{
+				Transform = Transform * Template->GetRelativeTransform();
+			}
+			Node = SCS->FindParentNode(Node);
+		}
+		return Transform;
+	}
+}
+
+bool UTEST_FractureData::IsPart(const UActorComponent* Component)
+{
+	static const FName PartTag(TEXT("part"));
+	const UStaticMeshComponent* MeshComponent = Cast<UStaticMeshComponent>(Component);
+	return MeshComponent != nullptr && MeshComponent->ComponentHasTag(PartTag) && MeshComponent->GetStaticMesh() != nullptr;
+}
+
+int32 UTEST_FractureData::BuildFromParts(UClass* DestructableClass)
+{
+	const ATEST_Destructable* Defaults = DestructableClass->GetDefaultObject<ATEST_Destructable>();
+	SourceMesh = Defaults->SolidMesh != nullptr ? Defaults->SolidMesh->GetStaticMesh() : nullptr;
+	Pieces.Reset();
+
+	// Every part component template becomes one piece
+	for (UBlueprintGeneratedClass* Class = Cast<UBlueprintGeneratedClass>(DestructableClass); Class != nullptr; Class = Cast<UBlueprintGeneratedClass>(Class->GetSuperClass()))
+	{
+		USimpleConstructionScript* SCS = Class->SimpleConstructionScript;
+		if (SCS == nullptr)
+		{
+			continue;
+		}
+		for (USCS_Node* Node : SCS->GetAllNodes())
+		{
+			if (!IsPart(Node->ComponentTemplate))
+			{
+				continue;
+			}
+			UStaticMeshComponent* Template = CastChecked<UStaticMeshComponent>(Node->ComponentTemplate);
+			UStaticMesh* Mesh = Template->GetStaticMesh();
+
+			FTEST_DebrisPiece& Piece = Pieces.AddDefaulted_GetRef();
+			Piece.Mesh = Mesh;
+			Piece.RelativeTransform = TESTFractureData::GetNodeTransform(SCS, Node);
+			for (int32 MaterialIndex = 0; MaterialIndex < Template->OverrideMaterials.Num(); ++MaterialIndex)
+			{
+				Piece.Materials.Add(Template->OverrideMaterials[MaterialIndex]);
+			}
+			if (Mesh->BodySetup != nullptr)
+			{
+				Piece.Mass = Mesh->BodySetup->CalculateMass(Template);
+			}
+			// Pieces fly away from center of object
+			const FVector PieceCenter = Piece.RelativeTransform.TransformPosition(Mesh->GetBounds().Origin);
+			Piece.ImpulseDirection = PieceCenter.GetSafeNormal();
+		}
+	}
+	return Pieces.Num();
+}
+#endif
@@ -0,0 +1,37 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "TEST_DebrisPool.h"
+#include "TEST_FractureData.generated.h"
+
+/**
+ * Precomputed pieces of destructable mesh. Built by
+ * UTEST_BuildFractureDataCommandlet, can be shared by many destructables.
+ * Destructable Blueprints also keep one built from their parts on save
+ */
+UCLASS(BlueprintType)
+class TEST_API UTEST_FractureData : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	// Mesh which is broken to these pieces
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Fracture")
+	UStaticMesh* SourceMesh;
+
+	// Pieces in actor space with mass and impulse direction
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Fracture")
+	TArray<FTEST_DebrisPiece> Pieces;
+
+#if WITH_EDITOR
+	// Fill pieces from "part" component templates of Blueprint class
+	// and its Blueprint parents, returns number of pieces
+	int32 BuildFromParts(UClass* DestructableClass);
+
+	// True if component or its template is a part of destructable
+	static bool IsPart(const UActorComponent* Component);
+#endif
+};
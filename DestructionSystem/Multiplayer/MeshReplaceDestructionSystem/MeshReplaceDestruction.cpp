@@ -4,17 +4,36 @@
 #include "MeshReplaceDestruction.h"
 #include "Kismet/GameplayStatics.h"
 #include "TimerManager.h"
-#include "TESTProjectile.h"
+#include "TEST_DebrisPool.h"
+#include "TEST_FractureData.h"
+#include "TEST_DestructableInstances.h"
+#include "TEST_DestructionScheduler.h"
+#include "TEST_DestructableRegistry.h"
+#include "TEST_ImpactEffects.h"
+#if WITH_EDITOR
+#include "Engine/BlueprintGeneratedClass.h"
+#include "Engine/SimpleConstructionScript.h"
+#include "Engine/SCS_Node.h"
+#endif
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Coalesced hits"), STAT_TESTCoalescedHits, STATGROUP_Game);
 
 // Sets default values
 ATEST_Destructable::ATEST_Destructable()
 {
 	bReplicates = true;
 	PrimaryActorTick.bCanEverTick = false;
+	InteractionCapabilities |= ETESTInteractionCapability::Destructible;
+
+	// Destructables are placed in level and sleep until state change
+	NetDormancy = DORM_Initial;
+	NetUpdateFrequency = 2.f;
+	MinNetUpdateFrequency = 0.5f;
+	NetCullDistanceSquared = FMath::Square(10000.f);
+
 	// Base mesh which will store whole mesh
 	SolidMesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("BaseMeshComp"));
 	SolidMesh->SetMobility(EComponentMobility::Static);
-	SolidMesh->OnComponentHit.AddDynamic(this, &ATEST_Destructable::OnHit);
 
 	SolidMesh->SetCollisionObjectType(ECC_WorldDynamic);
 	SolidMesh->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
@@ -23,46 +42,95 @@ ATEST_Destructable::ATEST_Destructable()
 	SolidMesh->SetCollisionResponseToChannel(ECC_Camera, ECR_Ignore);
 	SolidMesh->SetCanEverAffectNavigation(false);
 
-	DamagedMaterial = CreateDefaultSubobject<UMaterialInterface>(TEXT("DamagedMaterial"));
+	DamagedMaterial = nullptr;
 
 	RootComponent = SolidMesh;
 }
 
-void ATEST_Destructable::ConfigurePartsOnStart()
+#if WITH_EDITOR
+void ATEST_Destructable::PreSave(const ITargetPlatform* TargetPlatform)
 {
-	// Get all parts and set initial values
-	for (UStaticMeshComponent* Comp : GetPartsComponents())
+	Super::PreSave(TargetPlatform);
+	UBlueprintGeneratedClass* Class = Cast<UBlueprintGeneratedClass>(GetClass());
+	if (!HasAnyFlags(RF_ClassDefaultObject) || Class == nullptr || Class->SimpleConstructionScript == nullptr)
+	{
+		return;
+	}
+
+	// Precomputed pieces replace parts, nothing to build
+	if (FractureData != nullptr)
+	{
+		PartsData = nullptr;
+	}
+	else
 	{
-		Comp->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		Comp->SetMobility(EComponentMobility::Static);
-		Comp->SetWalkableSlopeOverride(FWalkableSlopeOverride(WalkableSlope_Unwalkable, 0.f));
-		Comp->CanCharacterStepUpOn = ECB_No;
-		Comp->SetHiddenInGame(true); // hide parts on start
+		if (PartsData == nullptr)
+		{
+			PartsData = NewObject<UTEST_FractureData>(this, TEXT("PartsData"));
+		}
+		PartsData->BuildFromParts(Class);
+	}
+
+	// Cooked game strips editor only templates, parts exist only in pool
+	for (USCS_Node* Node : Class->SimpleConstructionScript->GetAllNodes())
+	{
+		if (UTEST_FractureData::IsPart(Node->ComponentTemplate))
+		{
+			Node->ComponentTemplate->bIsEditorOnly = true;
+		}
 	}
 }
 
-TArray<UStaticMeshComponent*> ATEST_Destructable::GetPartsComponents()
+void ATEST_Destructable::ConfigurePartsOnStart()
 {
-	// Function to find parts if array of components is empty
-	if (PartsComponents.Num() == 0)
+	// Blueprint changed after last save, build pieces for this session
+	// unless precomputed pieces are used
+	if (FractureData == nullptr)
 	{
-		// Store all static mesh components 
-		TInlineComponentArray<UStaticMeshComponent*> ComponentsByClass; 
-		GetComponents(ComponentsByClass);
+		ATEST_Destructable* Defaults = GetClass()->GetDefaultObject<ATEST_Destructable>();
+		if (Defaults->PartsData == nullptr && Cast<UBlueprintGeneratedClass>(GetClass()) != nullptr)
+		{
+			Defaults->PartsData = NewObject<UTEST_FractureData>(Defaults, NAME_None, RF_Transient);
+			Defaults->PartsData->BuildFromParts(GetClass());
+		}
+		if (PartsData == nullptr)
+		{
+			PartsData = Defaults->PartsData;
+		}
+	}
 
-		// Store all static mesh components with "part" tag which are our parts
-		TArray<UStaticMeshComponent*> Parts;
-		Parts.Reserve(Parts.Num());
-		for (UStaticMeshComponent* Component : ComponentsByClass)
+	TInlineComponentArray<UStaticMeshComponent*> Components;
+	GetComponents(Components);
+	for (UStaticMeshComponent* Component : Components)
+	{
+		if (UTEST_FractureData::IsPart(Component))
 		{
-			if (Component->ComponentHasTag(TEXT("part")))
-			{
-				Parts.Push(Component);
-			}
+			Component->DestroyComponent();
 		}
-		PartsComponents = Parts;
 	}
-	return PartsComponents;
+}
+#endif
+
+void ATEST_Destructable::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	// Old two hit behaviour: damaged at half health, broken at zero
+	if (DamageStages.Num() == 0)
+	{
+		FTEST_DamageStage& DefaultStage = DamageStages.AddDefaulted_GetRef();
+		DefaultStage.HealthFraction = 0.5f;
+		DefaultStage.Material = DamagedMaterial;
+		DefaultStage.Sound = DamageSound;
+	}
+	Health = MaxHealth;
+}
+
+const TArray<FTEST_DebrisPiece>& ATEST_Destructable::GetPieces() const
+{
+	static const TArray<FTEST_DebrisPiece> NoPieces;
+	const UTEST_FractureData* Data = FractureData != nullptr ? FractureData : PartsData;
+	return Data != nullptr ? Data->Pieces : NoPieces;
 }
 
 void ATEST_Destructable::ShowParts(FVector DealerLocation)
@@ -70,32 +138,31 @@ void ATEST_Destructable::ShowParts(FVector DealerLocation)
 	// Add impulse to throw away parts after destroy
 	float ImpulseStrength = -500.f;
 	FVector Impulse = (DealerLocation - GetActorLocation()).GetSafeNormal() * ImpulseStrength;
-	for (UStaticMeshComponent* Comp : GetPartsComponents())
-	{
-		Comp->SetMobility(EComponentMobility::Movable);
-		Comp->SetHiddenInGame(false);
-		Comp->SetCollisionEnabled(ECollisionEnabled::PhysicsOnly);
-		Comp->SetSimulatePhysics(true);
-		Comp->DetachFromParent();
-		Comp->AddImpulse(Impulse, NAME_None, true); // Fire impulse
-	}
+	GetWorld()->GetSubsystem<UTEST_DebrisPool>()->SpawnDebris(GetPieces(), GetActorTransform(), Impulse, DestroyTime, BreakSeed);
 }
 
-void ATEST_Destructable::Break(AActor* InBreakingActor)
+void ATEST_Destructable::Break(const FVector& DealerLocation)
 {
-	// If destroyed do nothing
-	if (bDestroyed)
-		return;
-
-	bDestroyed = true;
 	// Hide base mesh
 	SolidMesh->SetHiddenInGame(true);
 	SolidMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-	ShowParts(InBreakingActor->GetActorLocation());
-	// Destroy mesh after detach from parent
+	ShowParts(DealerLocation);
+	// Parts are in debris pool, base mesh is not needed anymore
 	SolidMesh->DestroyComponent();
-	UWorld* World = GetWorld();
-	World->GetTimerManager().SetTimer(DestroyTimer, this, &ATEST_Destructable::DestroyParts, DestroyTime, false);
+}
+
+void ATEST_Destructable::ExecuteBreak()
+{
+	if (SolidMesh == nullptr || SolidMesh->IsBeingDestroyed())
+	{
+		return;
+	}
+	UTEST_ImpactEffects* ImpactEffects = GetWorld()->GetSubsystem<UTEST_ImpactEffects>();
+	ImpactEffects->PlaySound(BreakSound, GetActorLocation());
+	FVector SpawnLocation = RootComponent->GetComponentLocation();
+	FRotator SpawnRotation = RootComponent->GetComponentRotation();
+	ImpactEffects->SpawnEmitter(ParticleEmitter, SpawnLocation, SpawnRotation);
+	Break(BreakDealerLocation);
 }
 
 void ATEST_Destructable::DestroyParts()
@@ -103,32 +170,192 @@ void ATEST_Destructable::DestroyParts()
 	this->Destroy();
 }
 
-void ATEST_Destructable::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
+// Replicates variables
+void ATEST_Destructable::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ATEST_Destructable, BreakDealerLocation);
+	DOREPLIFETIME(ATEST_Destructable, BreakSeed);
+	DOREPLIFETIME(ATEST_Destructable, State);
+	DOREPLIFETIME(ATEST_Destructable, DamageStage);
+}
+
+float ATEST_Destructable::TakeDamage(float DamageAmount, FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
+{
+	if (IsRepeatedHit(DamageCauser))
+	{
+		INC_DWORD_STAT(STAT_TESTCoalescedHits);
+		return 0.f;
+	}
+	const float ActualDamage = Super::TakeDamage(DamageAmount, DamageEvent, EventInstigator, DamageCauser);
+	if (!HasAuthority() || ActualDamage <= 0.f || State == ETESTDestructableState::Broken)
+	{
+		return ActualDamage;
+	}
+
+	// First hit this frame schedules one application for all of them
+	if (PendingDamage <= 0.f)
+	{
+		GetWorldTimerManager().SetTimerForNextTick(this, &ATEST_Destructable::ApplyPendingDamage);
+	}
+	PendingDamage += ActualDamage;
+	PendingInstigator = EventInstigator;
+
+	// Parts are thrown away from last hit
+	if (DamageEvent.IsOfType(FPointDamageEvent::ClassID))
+	{
+		PendingDealerLocation = static_cast<const FPointDamageEvent&>(DamageEvent).HitInfo.Location;
+	}
+	else if (DamageEvent.IsOfType(FRadialDamageEvent::ClassID))
+	{
+		PendingDealerLocation = static_cast<const FRadialDamageEvent&>(DamageEvent).Origin;
+	}
+	else
+	{
+		PendingDealerLocation = DamageCauser != nullptr ? DamageCauser->GetActorLocation() : GetActorLocation();
+	}
+	return ActualDamage;
+}
+
+bool ATEST_Destructable::IsRepeatedHit(const AActor* DamageCauser)
+{
+	if (CoalesceFrame != GFrameCounter)
+	{
+		CoalesceFrame = GFrameCounter;
+		FrameDamageCausers.Reset();
+	}
+	if (!EnumHasAnyFlags(ATEST_CapabilityActor::GetCapabilities(DamageCauser), ETESTInteractionCapability::Projectile))
+	{
+		return false;
+	}
+	if (FrameDamageCausers.Contains(DamageCauser))
+	{
+		return true;
+	}
+	FrameDamageCausers.Add(DamageCauser);
+	return false;
+}
+
+void ATEST_Destructable::ApplyPendingDamage()
 {
-	// Response only on projectile
-	if (OtherActor->GetClass()->IsChildOf(ATESTProjectile::StaticClass()))
+	const float Damage = PendingDamage;
+	PendingDamage = 0.f;
+	if (State == ETESTDestructableState::Broken)
+	{
+		return;
+	}
+
+	Health = FMath::Max(Health - Damage, 0.f);
+	if (Health <= 0.f)
+	{
+		SetState(ETESTDestructableState::Broken, PendingDealerLocation);
+		return;
+	}
+
+	// Count reached stages, several can be passed at once
+	uint8 NewStage = 0;
+	for (const FTEST_DamageStage& Stage : DamageStages)
 	{
-		// Check if is damaged, depending on this state, call functions and play a sound
-		if (bDamaged)
+		if (Health <= Stage.HealthFraction * MaxHealth)
 		{
-			if (BreakSound != NULL)
-			{
-				UGameplayStatics::PlaySoundAtLocation(this, BreakSound, GetActorLocation());
-			}
-			FVector SpawnLocation = RootComponent->GetComponentLocation();
-			FRotator SpawnRotation = RootComponent->GetComponentRotation();
-			UGameplayStatics::SpawnEmitterAtLocation(GetWorld(), ParticleEmitter, SpawnLocation, SpawnRotation);
-			Break(OtherActor);
+			++NewStage;
 		}
-		else 
+	}
+	if (NewStage > DamageStage)
+	{
+		SetDamageStage(NewStage);
+		SetState(ETESTDestructableState::Damaged, PendingDealerLocation);
+	}
+}
+
+void ATEST_Destructable::SetDamageStage(uint8 NewStage)
+{
+	const uint8 PreviousStage = DamageStage;
+	DamageStage = NewStage;
+	FlushNetDormancy();
+	ApplyDamageStage(PreviousStage);
+}
+
+void ATEST_Destructable::OnRep_DamageStage(uint8 PreviousStage)
+{
+	ApplyDamageStage(PreviousStage);
+}
+
+void ATEST_Destructable::ApplyDamageStage(uint8 PreviousStage)
+{
+	if (DamageStage <= PreviousStage || !DamageStages.IsValidIndex(DamageStage - 1))
+	{
+		return;
+	}
+
+	// Damaged object needs own mesh
+	StopInstancedRendering();
+
+	// Broken object plays only break effects
+	if (State == ETESTDestructableState::Broken)
+	{
+		return;
+	}
+
+	// Only last reached stage is shown when several are passed at once
+	const FTEST_DamageStage& Stage = DamageStages[DamageStage - 1];
+	if (Stage.Material != nullptr)
+	{
+		SolidMesh->SetMaterial(0, Stage.Material);
+	}
+	UTEST_ImpactEffects* ImpactEffects = GetWorld()->GetSubsystem<UTEST_ImpactEffects>();
+	ImpactEffects->PlaySound(Stage.Sound, GetActorLocation());
+	ImpactEffects->SpawnEmitter(Stage.Particle, GetActorLocation(), GetActorRotation());
+}
+
+void ATEST_Destructable::SetState(ETESTDestructableState NewState, const FVector& DealerLocation)
+{
+	if (!HasAuthority() || NewState == State)
+	{
+		return;
+	}
+	const ETESTDestructableState PreviousState = State;
+	State = NewState;
+	BreakDealerLocation = DealerLocation;
+	if (NewState == ETESTDestructableState::Broken)
+	{
+		BreakSeed = FMath::Rand();
+	}
+	// Wake up only on state change, send it and sleep again
+	FlushNetDormancy();
+	ApplyState(PreviousState);
+}
+
+void ATEST_Destructable::OnRep_State(ETESTDestructableState PreviousState)
+{
+	ApplyState(PreviousState);
+}
+
+void ATEST_Destructable::ApplyState(ETESTDestructableState PreviousState)
+{
+	// Damaged or broken object needs own mesh
+	StopInstancedRendering();
+
+	// Damaged look is set by damage stage, break is handled here
+	if (State == ETESTDestructableState::Broken && PreviousState != ETESTDestructableState::Broken)
+	{
+		// Broken object stops blocking immediately
+		SolidMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+		// Server destroys actor, it is replicated to clients
+		if (HasAuthority())
 		{
-			if (DamageSound != NULL)
+			UWorld* World = GetWorld();
+			World->GetTimerManager().SetTimer(DestroyTimer, this, &ATEST_Destructable::DestroyParts, DestroyTime, false);
+			World->GetSubsystem<UTEST_DestructableRegistry>()->Unregister(this);
+			// Chain reaction goes through queue, neighbours explode on next frames
+			if (bExplodeOnBreak)
 			{
-				UGameplayStatics::PlaySoundAtLocation(this, DamageSound, GetActorLocation());
+				World->GetSubsystem<UTEST_RadialDamage>()->QueueExplosion(GetActorLocation(), ExplosionDamage, Explosion, nullptr, PendingInstigator.Get(), this);
 			}
-			SolidMesh->SetMaterial(0, DamagedMaterial);
-			bDamaged = true;
 		}
+		// Sound, particles and parts are spawned by scheduler within frame budget
+		GetWorld()->GetSubsystem<UTEST_DestructionScheduler>()->RequestBreak(this);
 	}
 }
 
@@ -136,5 +363,41 @@ void ATEST_Destructable::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor,
 void ATEST_Destructable::BeginPlay()
 {
 	Super::BeginPlay();
+#if WITH_EDITOR
 	ConfigurePartsOnStart();
+#endif
+
+	// Only server applies area damage
+	if (HasAuthority())
+	{
+		GetWorld()->GetSubsystem<UTEST_DestructableRegistry>()->Register(this);
+	}
+
+	// Intact object is drawn as instance, own mesh keeps collision
+	if (bUseInstancedRendering && GetWorld()->GetSubsystem<UTEST_DestructableInstances>()->AddInstance(this))
+	{
+		SolidMesh->SetVisibility(false);
+	}
+}
+
+void ATEST_Destructable::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UTEST_DestructableInstances* Instances = GetWorld()->GetSubsystem<UTEST_DestructableInstances>())
+	{
+		Instances->RemoveInstance(this);
+	}
+	if (UTEST_DestructableRegistry* Registry = GetWorld()->GetSubsystem<UTEST_DestructableRegistry>())
+	{
+		Registry->Unregister(this);
+	}
+	Super::EndPlay(EndPlayReason);
+}
+
+void ATEST_Destructable::StopInstancedRendering()
+{
+	if (InstanceComponent != nullptr)
+	{
+		GetWorld()->GetSubsystem<UTEST_DestructableInstances>()->RemoveInstance(this);
+		SolidMesh->SetVisibility(true);
+	}
 }
\ No newline at end of file
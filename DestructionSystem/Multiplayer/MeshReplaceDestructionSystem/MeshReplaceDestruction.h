@@ -7,10 +7,44 @@
 #include "Components/StaticMeshComponent.h"
 #include "Particles/ParticleSystemComponent.h"
 #include "Net/UnrealNetwork.h"
+#include "TEST_InteractionCapabilities.h"
+#include "TEST_RadialDamage.h"
 #include "TEST_Destructable.generated.h"
 
+struct FTEST_DebrisPiece;
+
+// States of destructable object
+UENUM()
+enum class ETESTDestructableState : uint8
+{
+	Solid,
+	Damaged,
+	Broken
+};
+
+// Look of destructable after its health drops to threshold
+USTRUCT(BlueprintType)
+struct FTEST_DamageStage
+{
+	GENERATED_BODY()
+
+	// Stage starts when health is at or below this part of max health
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Damage", meta = (ClampMin = "0.0", ClampMax = "1.0"))
+	float HealthFraction = 0.5f;
+
+	// Material set on main mesh, none keeps current one
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Damage")
+	class UMaterialInterface* Material = nullptr;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Damage")
+	class USoundBase* Sound = nullptr;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Damage")
+	class UParticleSystem* Particle = nullptr;
+};
+
 UCLASS()
-class TEST_API ATEST_Destructable : public AActor
+class TEST_API ATEST_Destructable : public ATEST_CapabilityActor
 {
 	GENERATED_BODY()
 	
@@ -18,18 +52,30 @@ public:
 	// Sets default values for this actor's properties
 	ATEST_Destructable();
 
+	// Required network setup
+	void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 	// Main mesh
 	UPROPERTY(EditAnywhere)
 	class UStaticMeshComponent* SolidMesh;
 
-	// Material to change after change state to Damaged
+	// Material of default damage stage, used when DamageStages is empty
 	UPROPERTY(EditAnywhere)
 	class UMaterialInterface* DamagedMaterial;
 
-	// Sound on change state to damaged
+	// Sound of default damage stage, used when DamageStages is empty
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
 	class USoundBase* DamageSound;
 
+	// Health at start, object breaks when it reaches zero
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay, meta = (ClampMin = "0.0"))
+	float MaxHealth = 20.f;
+
+	// Stages ordered from highest health fraction. When empty, one stage
+	// at half health with DamagedMaterial and DamageSound is used
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
+	TArray<FTEST_DamageStage> DamageStages;
+
 	// Sound on break main mesh to parts
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
 	class USoundBase* BreakSound;
@@ -37,44 +83,157 @@ public:
 	// Particles on break
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
 	class UParticleSystem* ParticleEmitter;
-	
-	UFUNCTION()
-	void OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
+
+	// Precomputed pieces, if set part components are not needed
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
+	class UTEST_FractureData* FractureData;
+
+	// Explode on break and damage objects and pawns around
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay)
+	bool bExplodeOnBreak = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay, meta = (EditCondition = "bExplodeOnBreak"))
+	float ExplosionDamage = 20.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay, meta = (EditCondition = "bExplodeOnBreak"))
+	FTEST_ExplosionParams Explosion;
+
+	// Draw intact object as instance shared with other destructables
+	// using the same mesh, own mesh is shown after damage
+	UPROPERTY(EditAnywhere, Category = Rendering)
+	bool bUseInstancedRendering = true;
+
+	// Damage is collected and applied once on next tick, so many hits
+	// in one frame (e.g. shotgun pellets) change state only once
+	virtual float TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser) override;
+
+	ETESTDestructableState GetState() const { return State; }
+
+	float GetHealth() const { return Health; }
+
+	// Shared instance drawing this object, null when own mesh is drawn
+	class UHierarchicalInstancedStaticMeshComponent* GetInstanceComponent() const { return InstanceComponent; }
+
+	int32 GetInstanceIndex() const { return InstanceIndex; }
+
+	// Play break sound and particles and throw parts,
+	// called by UTEST_DestructionScheduler
+	void ExecuteBreak();
+
+#if WITH_EDITOR
+	// Blueprint defaults store pieces of "part" components in PartsData
+	// and parts become editor only, so instances never create them
+	virtual void PreSave(const class ITargetPlatform* TargetPlatform) override;
+#endif
 
 private:
-	// Cofigure initial values for parts like
-	// invisibility on start
+	// Pieces of "part" components added in Blueprint, built when Blueprint
+	// is saved and shared by all instances. Not used with FractureData
+	UPROPERTY()
+	class UTEST_FractureData* PartsData;
+
+	// Pieces thrown on break, empty if class has no parts
+	const TArray<FTEST_DebrisPiece>& GetPieces() const;
+
+#if WITH_EDITOR
+	// Game started from editor still creates editor only parts
+	// and may use Blueprint which is not saved yet
 	void ConfigurePartsOnStart();
-	
-	// Function to collect all SolidMesh childs with tag part,
-	// Parts and main mesh are added in Blueprint
-	TArray<UStaticMeshComponent*> GetPartsComponents();
-	
-	// Store all parts 
-	TArray<UStaticMeshComponent*> PartsComponents;
+#endif
 
-	// Show parts and change value of collision and physics
+	// Take parts from debris pool and throw them away
 	void ShowParts(FVector DealerLocation);
 	
-	// Init ShowParts, set timer to destroy parts, 
-	// destroy main mesh after detach childrens
-	void Break(AActor* InBreakingActor);
+	// Hide and destroy main mesh, init ShowParts
+	void Break(const FVector& DealerLocation);
 
 	// After some time destroy parts
 	void DestroyParts();
 
 private:
-	// Flags to change state of object
-	// States: Solid, Damaged, Broken
-	bool bDamaged = false;
-	bool bDestroyed = false;
+	// Location of actor which broke object, used to throw parts.
+	// Declared before State so it is already set in OnRep_State
+	UPROPERTY(Replicated)
+	FVector_NetQuantize BreakDealerLocation;
+
+	// Seed for debris impulse variation, same on every client
+	UPROPERTY(Replicated)
+	int32 BreakSeed = 0;
+
+	// Current state, changed only on server and replicated to clients
+	UPROPERTY(ReplicatedUsing = OnRep_State)
+	ETESTDestructableState State = ETESTDestructableState::Solid;
+
+	// Number of damage stages reached, 0 is not damaged
+	UPROPERTY(ReplicatedUsing = OnRep_DamageStage)
+	uint8 DamageStage = 0;
+
+	// Server only, clients know only stage
+	float Health = 0.f;
+
+	// Damage received this frame, applied on next tick
+	float PendingDamage = 0.f;
+
+	FVector PendingDealerLocation;
+
+	// Last damage instigator, credited for chain explosion
+	TWeakObjectPtr<AController> PendingInstigator;
+
+	// Projectiles which damaged object in CoalesceFrame, only compared
+	TArray<const AActor*, TInlineAllocator<8>> FrameDamageCausers;
+
+	uint64 CoalesceFrame = 0;
+
+	// True if causer already damaged object this frame. Projectile
+	// actor can report several hits per contact, lightweight
+	// projectiles and other causers are never coalesced
+	bool IsRepeatedHit(const AActor* DamageCauser);
+
+	UFUNCTION()
+	void OnRep_State(ETESTDestructableState PreviousState);
+
+	UFUNCTION()
+	void OnRep_DamageStage(uint8 PreviousStage);
+
+	// Subtract damage collected this frame and update stage and state
+	void ApplyPendingDamage();
+
+	// Change state on server
+	void SetState(ETESTDestructableState NewState, const FVector& DealerLocation);
+
+	// Change stage on server
+	void SetDamageStage(uint8 NewStage);
+
+	// Show look of reached stage
+	void ApplyDamageStage(uint8 PreviousStage);
+
+	// Swap material, play sound and particles, show parts
+	// depending on transition from PreviousState to State
+	void ApplyState(ETESTDestructableState PreviousState);
+
+	// Stop drawing as instance and show own mesh
+	void StopInstancedRendering();
+
+	// Instance drawing this object, set by UTEST_DestructableInstances
+	UPROPERTY(Transient)
+	class UHierarchicalInstancedStaticMeshComponent* InstanceComponent;
+
+	int32 InstanceIndex = INDEX_NONE;
+
+	friend class UTEST_DestructableInstances;
 
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	// Blueprint components are created, set up damage stages and health
+	virtual void PostInitializeComponents() override;
+
 protected:
-	// Variables to set time to destroy parts
+	// Variables to set time to destroy parts,
+	// after this time parts return to debris pool
 	FTimerHandle DestroyTimer;
 	float DestroyTime = 10;
 };
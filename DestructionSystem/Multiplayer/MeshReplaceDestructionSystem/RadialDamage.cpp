@@ -0,0 +1,133 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TEST_RadialDamage.h"
+#include "TEST_DestructableRegistry.h"
+#include "TEST_Destructable.h"
+#include "TEST_DestructionStats.h"
+#include "GameFramework/DamageType.h"
+#include "GameFramework/Pawn.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("Radial damage"), STAT_TESTRadialDamage, STATGROUP_TESTDestruction);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Explosions"), STAT_TESTExplosions, STATGROUP_TESTDestruction);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Explosion victims"), STAT_TESTExplosionVictims, STATGROUP_TESTDestruction);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Dropped explosions"), STAT_TESTDroppedExplosions, STATGROUP_TESTDestruction);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pending explosions"), STAT_TESTPendingExplosions, STATGROUP_TESTDestruction);
+
+void UTEST_RadialDamage::Deinitialize()
+{
+	DEC_DWORD_STAT_BY(STAT_TESTPendingExplosions, GetNumPendingExplosions());
+	PendingExplosions.Empty();
+	PendingHead = 0;
+	Super::Deinitialize();
+}
+
+void UTEST_RadialDamage::ApplyExplosion(const FVector& Origin, float BaseDamage, const FTEST_ExplosionParams& Params, TSubclassOf<UDamageType> DamageType, AController* Instigator, AActor* DamageCauser)
+{
+	SCOPE_CYCLE_COUNTER(STAT_TESTRadialDamage);
+	INC_DWORD_STAT(STAT_TESTExplosions);
+
+	// One grid query for destructables and one overlap for pawns
+	Victims.Reset();
+	TArray<ATEST_Destructable*> Destructables;
+	if (UTEST_DestructableRegistry* Registry = GetWorld()->GetSubsystem<UTEST_DestructableRegistry>())
+	{
+		Registry->GetDestructablesInRadius(Origin, Params.OuterRadius, Destructables);
+	}
+	Victims.Append(Destructables);
+
+	// Capsule and mesh of one pawn can both overlap, pawn is damaged once
+	TArray<FOverlapResult> Overlaps;
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(TESTRadialDamage), false);
+	GetWorld()->OverlapMultiByObjectType(Overlaps, Origin, FQuat::Identity, FCollisionObjectQueryParams(ECC_Pawn), FCollisionShape::MakeSphere(Params.OuterRadius), QueryParams);
+	for (const FOverlapResult& Overlap : Overlaps)
+	{
+		APawn* Pawn = Cast<APawn>(Overlap.GetActor());
+		if (Pawn != nullptr)
+		{
+			Victims.AddUnique(Pawn);
+		}
+	}
+
+	// Falloff is computed by engine from distance to hit, victim
+	// location is used as hit instead of tracing to its components
+	FRadialDamageEvent DamageEvent;
+	DamageEvent.DamageTypeClass = DamageType != nullptr ? DamageType : TSubclassOf<UDamageType>(UDamageType::StaticClass());
+	DamageEvent.Origin = Origin;
+	DamageEvent.Params = FRadialDamageParams(BaseDamage, Params.MinimumDamage, Params.InnerRadius, Params.OuterRadius, Params.DamageFalloff);
+	FHitResult& Hit = DamageEvent.ComponentHits.AddDefaulted_GetRef();
+	for (AActor* Victim : Victims)
+	{
+		if (Victim->IsPendingKill())
+		{
+			continue;
+		}
+		const FVector VictimLocation = Victim->GetActorLocation();
+		Hit = FHitResult(Victim, Cast<UPrimitiveComponent>(Victim->GetRootComponent()), VictimLocation, (VictimLocation - Origin).GetSafeNormal());
+		Victim->TakeDamage(BaseDamage, DamageEvent, Instigator, DamageCauser);
+		INC_DWORD_STAT(STAT_TESTExplosionVictims);
+	}
+	Victims.Reset();
+}
+
+bool UTEST_RadialDamage::QueueExplosion(const FVector& Origin, float BaseDamage, const FTEST_ExplosionParams& Params, TSubclassOf<UDamageType> DamageType, AController* Instigator, AActor* DamageCauser)
+{
+	// Bounded queue keeps huge chain reaction from growing without limit
+	if (GetNumPendingExplosions() >= MaxPendingExplosions)
+	{
+		INC_DWORD_STAT(STAT_TESTDroppedExplosions);
+		++NumDroppedExplosions;
+		return false;
+	}
+	FTEST_PendingExplosion& Explosion = PendingExplosions.AddDefaulted_GetRef();
+	Explosion.Origin = Origin;
+	Explosion.BaseDamage = BaseDamage;
+	Explosion.Params = Params;
+	Explosion.DamageType = DamageType;
+	Explosion.Instigator = Instigator;
+	Explosion.DamageCauser = DamageCauser;
+	INC_DWORD_STAT(STAT_TESTPendingExplosions);
+	return true;
+}
+
+void UTEST_RadialDamage::Tick(float DeltaTime)
+{
+	// Explosions queued while applying these wait for next frame
+	const int32 Count = FMath::Min(GetNumPendingExplosions(), FMath::Max(MaxExplosionsPerFrame, 1));
+	for (int32 Applied = 0; Applied < Count; ++Applied)
+	{
+		// Copied, queueing from ApplyExplosion can grow array
+		const FTEST_PendingExplosion Explosion = PendingExplosions[PendingHead++];
+		ApplyExplosion(Explosion.Origin, Explosion.BaseDamage, Explosion.Params, Explosion.DamageType, Explosion.Instigator.Get(), Explosion.DamageCauser.Get());
+	}
+	DEC_DWORD_STAT_BY(STAT_TESTPendingExplosions, Count);
+
+	// Applied explosions are dropped from front only when they are most of array
+	if (PendingHead == PendingExplosions.Num())
+	{
+		PendingExplosions.Reset();
+		PendingHead = 0;
+	}
+	else if (PendingHead > PendingExplosions.Num() / 2)
+	{
+		PendingExplosions.RemoveAt(0, PendingHead, false);
+		PendingHead = 0;
+	}
+}
+
+ETickableTickType UTEST_RadialDamage::GetTickableTickType() const
+{
+	// Default object must not tick
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+bool UTEST_RadialDamage::IsTickable() const
+{
+	return GetNumPendingExplosions() > 0;
+}
+
+TStatId UTEST_RadialDamage::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTEST_RadialDamage, STATGROUP_Tickables);
+}
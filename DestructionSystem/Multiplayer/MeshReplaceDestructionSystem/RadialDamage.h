@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "TEST_RadialDamage.generated.h"
+
+class UDamageType;
+
+// Shape and falloff of area damage
+USTRUCT(BlueprintType)
+struct FTEST_ExplosionParams
+{
+	GENERATED_BODY()
+
+	// Full damage is dealt inside this radius
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Explosion", meta = (ClampMin = "0.0"))
+	float InnerRadius = 50.f;
+
+	// Nothing is damaged outside this radius
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Explosion", meta = (ClampMin = "0.0"))
+	float OuterRadius = 300.f;
+
+	// Damage at outer radius
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Explosion", meta = (ClampMin = "0.0"))
+	float MinimumDamage = 0.f;
+
+	// Exponent of falloff between radii, 1 is linear
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Explosion", meta = (ClampMin = "0.0"))
+	float DamageFalloff = 1.f;
+};
+
+// Explosion waiting for next frame
+struct FTEST_PendingExplosion
+{
+	FVector Origin;
+	float BaseDamage = 0.f;
+	FTEST_ExplosionParams Params;
+	TSubclassOf<UDamageType> DamageType;
+	TWeakObjectPtr<AController> Instigator;
+	TWeakObjectPtr<AActor> DamageCauser;
+};
+
+/**
+ * Area damage for explosive projectiles and exploding destructables.
+ * Destructables are taken from UTEST_DestructableRegistry, pawns from
+ * one overlap on pawn channel, there are no visibility traces. Chain
+ * reactions are queued and limited per frame so one explosion can not
+ * stall server
+ */
+UCLASS(config=Game)
+class TEST_API UTEST_RadialDamage : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	// Damage everything in radius now, server only
+	void ApplyExplosion(const FVector& Origin, float BaseDamage, const FTEST_ExplosionParams& Params, TSubclassOf<UDamageType> DamageType, AController* Instigator, AActor* DamageCauser);
+
+	// Apply explosion on one of next frames, used by chain reactions.
+	// Returns false if queue is full and explosion is dropped
+	bool QueueExplosion(const FVector& Origin, float BaseDamage, const FTEST_ExplosionParams& Params, TSubclassOf<UDamageType> DamageType, AController* Instigator, AActor* DamageCauser);
+
+	int32 GetNumPendingExplosions() const { return PendingExplosions.Num() - PendingHead; }
+
+	// Explosions dropped because queue was full since world start
+	int32 GetNumDroppedExplosions() const { return NumDroppedExplosions; }
+
+	// Queued explosions applied in one frame
+	UPROPERTY(config)
+	int32 MaxExplosionsPerFrame = 8;
+
+	// Queued explosions above this are dropped
+	UPROPERTY(config)
+	int32 MaxPendingExplosions = 256;
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+	// End of FTickableGameObject interface
+
+private:
+	// Queue in order of arrival, applied from PendingHead
+	TArray<FTEST_PendingExplosion> PendingExplosions;
+
+	int32 PendingHead = 0;
+
+	int32 NumDroppedExplosions = 0;
+
+	// Victims of current explosion, kept to avoid allocations
+	TArray<AActor*> Victims;
+};
@@ -0,0 +1,32 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TEST_PlayerViews.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+
+void FTEST_PlayerViews::Gather(const UWorld* World, FTEST_ViewLocations& OutViewLocations, bool bLocalOnly)
+{
+	for (FConstPlayerControllerIterator Iterator = World->GetPlayerControllerIterator(); Iterator; ++Iterator)
+	{
+		const APlayerController* PlayerController = Iterator->Get();
+		if (PlayerController == nullptr || (bLocalOnly && !PlayerController->IsLocalController()))
+		{
+			continue;
+		}
+		FVector Location;
+		FRotator Rotation;
+		PlayerController->GetPlayerViewPoint(Location, Rotation);
+		OutViewLocations.Add(Location);
+	}
+}
+
+float FTEST_PlayerViews::GetClosestDistanceSquared(const FVector& Location, const FTEST_ViewLocations& ViewLocations)
+{
+	float ClosestDistanceSquared = MAX_flt;
+	for (const FVector& ViewLocation : ViewLocations)
+	{
+		ClosestDistanceSquared = FMath::Min(ClosestDistanceSquared, FVector::DistSquared(Location, ViewLocation));
+	}
+	return ClosestDistanceSquared;
+}
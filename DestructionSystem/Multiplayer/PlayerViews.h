@@ -0,0 +1,24 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UWorld;
+
+// View locations of players, on clients only local players are known
+typedef TArray<FVector, TInlineAllocator<16>> FTEST_ViewLocations;
+
+/**
+ * Player view points used to prioritize and cull cosmetic work
+ * (breaks, debris simulation, effects) by distance
+ */
+struct TEST_API FTEST_PlayerViews
+{
+	// Add view location of every player controller, only local
+	// controllers if bLocalOnly. Out is not emptied
+	static void Gather(const UWorld* World, FTEST_ViewLocations& OutViewLocations, bool bLocalOnly = false);
+
+	// Squared distance from location to closest view, MAX_flt without views
+	static float GetClosestDistanceSquared(const FVector& Location, const FTEST_ViewLocations& ViewLocations);
+};
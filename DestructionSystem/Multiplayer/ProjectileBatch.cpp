@@ -0,0 +1,196 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TEST_ProjectileBatch.h"
+#include "TESTProjectile.h"
+#include "TEST_LagCompensation.h"
+#include "TEST_ProjectileEvents.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+#include "Components/SphereComponent.h"
+#include "Kismet/GameplayStatics.h"
+#include "Engine/World.h"
+
+DECLARE_STATS_GROUP(TEXT("TEST Projectile Batch"), STATGROUP_TESTProjectileBatch, STATCAT_Advanced);
+DECLARE_CYCLE_STAT(TEXT("Step projectiles"), STAT_TESTProjectileBatchStep, STATGROUP_TESTProjectileBatch);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Projectiles in flight"), STAT_TESTProjectileBatchInFlight, STATGROUP_TESTProjectileBatch);
+
+void UTEST_ProjectileBatch::Deinitialize()
+{
+	DEC_DWORD_STAT_BY(STAT_TESTProjectileBatchInFlight, Positions.Num());
+	Positions.Empty();
+	Velocities.Empty();
+	Instigators.Empty();
+	Damages.Empty();
+	LifeRemaining.Empty();
+	Archetypes.Empty();
+	Super::Deinitialize();
+}
+
+void UTEST_ProjectileBatch::FireProjectile(TSubclassOf<ATESTProjectile> ProjectileClass, const FVector& Location, const FRotator& Rotation, APawn* Instigator, float CatchUpTime)
+{
+	if (ProjectileClass == nullptr)
+	{
+		return;
+	}
+	const ATESTProjectile* Archetype = ProjectileClass->GetDefaultObject<ATESTProjectile>();
+	GetOrSpawnEvents();
+
+	Positions.Add(Location);
+	Velocities.Add(Rotation.Vector() * Archetype->GetProjectileMovement()->InitialSpeed);
+	Instigators.Add(Instigator);
+	Damages.Add(Archetype->Damage);
+	LifeRemaining.Add(Archetype->InitialLifeSpan > 0.f ? Archetype->InitialLifeSpan : 3.0f);
+	Archetypes.Add(Archetype);
+	INC_DWORD_STAT(STAT_TESTProjectileBatchInFlight);
+
+	if (CatchUpTime > 0.f)
+	{
+		CatchUpProjectile(Positions.Num() - 1, CatchUpTime);
+	}
+}
+
+bool UTEST_ProjectileBatch::CatchUpProjectile(int32 Index, float CatchUpTime)
+{
+	const FVector Start = Positions[Index];
+	const FVector End = Start + Velocities[Index] * CatchUpTime;
+
+	// World is swept without pawns, characters are tested where shooting client saw them
+	FHitResult Hit;
+	UTEST_LagCompensation* LagCompensation = GetWorld()->GetSubsystem<UTEST_LagCompensation>();
+	const float RewindTime = LagCompensation->GetServerTime() - CatchUpTime;
+	const bool bHit = LagCompensation->SweepRewound(Start, End, Archetypes[Index]->GetCollisionComp(), RewindTime, Instigators[Index].Get(), Hit);
+
+	if (bHit)
+	{
+		ResolveImpact(Index, Hit);
+		RemoveProjectile(Index);
+		return true;
+	}
+	Positions[Index] = End;
+	LifeRemaining[Index] -= CatchUpTime;
+	return false;
+}
+
+void UTEST_ProjectileBatch::Tick(float DeltaTime)
+{
+	StepProjectiles(DeltaTime);
+}
+
+ETickableTickType UTEST_ProjectileBatch::GetTickableTickType() const
+{
+	// Default object must not tick
+	return IsTemplate() ? ETickableTickType::Never : ETickableTickType::Conditional;
+}
+
+bool UTEST_ProjectileBatch::IsTickable() const
+{
+	return Positions.Num() > 0;
+}
+
+TStatId UTEST_ProjectileBatch::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UTEST_ProjectileBatch, STATGROUP_Tickables);
+}
+
+void UTEST_ProjectileBatch::StepProjectiles(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_TESTProjectileBatchStep);
+
+	UWorld* World = GetWorld();
+	const float GravityZ = World->GetGravityZ();
+
+	FHitResult Hit;
+
+	// Go backwards so removed projectiles can be swapped with last one
+	for (int32 Index = Positions.Num() - 1; Index >= 0; --Index)
+	{
+		LifeRemaining[Index] -= DeltaTime;
+		if (LifeRemaining[Index] <= 0.f)
+		{
+			RemoveProjectile(Index);
+			continue;
+		}
+
+		const ATESTProjectile* Archetype = Archetypes[Index];
+		const UProjectileMovementComponent* Movement = Archetype->GetProjectileMovement();
+		FVector& Velocity = Velocities[Index];
+		Velocity.Z += GravityZ * Movement->ProjectileGravityScale * DeltaTime;
+		if (Movement->MaxSpeed > 0.f)
+		{
+			Velocity = Velocity.GetClampedToMaxSize(Movement->MaxSpeed);
+		}
+
+		const FVector End = Positions[Index] + Velocity * DeltaTime;
+		if (SweepProjectile(Index, End, Hit))
+		{
+			ResolveImpact(Index, Hit);
+			RemoveProjectile(Index);
+			continue;
+		}
+		Positions[Index] = End;
+	}
+}
+
+bool UTEST_ProjectileBatch::SweepProjectile(int32 Index, const FVector& End, FHitResult& OutHit) const
+{
+	// Sweep with the same shape and profile as projectile actor
+	FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(TESTProjectileBatch), false);
+	if (APawn* Instigator = Instigators[Index].Get())
+	{
+		QueryParams.AddIgnoredActor(Instigator);
+	}
+	const USphereComponent* Collision = Archetypes[Index]->GetCollisionComp();
+	return GetWorld()->SweepSingleByProfile(OutHit, Positions[Index], End, FQuat::Identity, Collision->GetCollisionProfileName(), FCollisionShape::MakeSphere(Collision->GetUnscaledSphereRadius()), QueryParams);
+}
+
+void UTEST_ProjectileBatch::ResolveImpact(int32 Index, const FHitResult& Hit)
+{
+	AActor* OtherActor = Hit.GetActor();
+	UPrimitiveComponent* OtherComp = Hit.GetComponent();
+	APawn* Instigator = Instigators[Index].Get();
+	const ATESTProjectile* Archetype = Archetypes[Index];
+	AController* InstigatorController = Instigator != nullptr ? Instigator->GetController() : nullptr;
+
+	if (Archetype->bExplosive)
+	{
+		GetWorld()->GetSubsystem<UTEST_RadialDamage>()->ApplyExplosion(Hit.Location, Damages[Index], Archetype->Explosion, Archetype->DamageType, InstigatorController, Instigator);
+	}
+	else if (OtherActor != nullptr && OtherComp != nullptr)
+	{
+		if (OtherComp->IsSimulatingPhysics())
+		{
+			OtherComp->AddImpulseAtLocation(Velocities[Index] * 100.0f, Hit.Location);
+		}
+		// Destructables take damage the same way as from projectile actor
+		UGameplayStatics::ApplyPointDamage(OtherActor, Damages[Index], Velocities[Index].GetSafeNormal(), Hit, InstigatorController, Instigator, Archetype->DamageType);
+	}
+
+	// Let clients play impact effect, instigator may be already destroyed
+	if (ATEST_ProjectileEvents* ProjectileEvents = GetOrSpawnEvents())
+	{
+		ProjectileEvents->MulticastProjectileImpact(Archetype->GetClass(), Hit.Location, Instigator);
+	}
+}
+
+ATEST_ProjectileEvents* UTEST_ProjectileBatch::GetOrSpawnEvents()
+{
+	UWorld* World = GetWorld();
+	if (!Events.IsValid() && World->GetNetMode() != NM_Client)
+	{
+		FActorSpawnParameters SpawnParameters;
+		SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		Events = World->SpawnActor<ATEST_ProjectileEvents>(SpawnParameters);
+	}
+	return Events.Get();
+}
+
+void UTEST_ProjectileBatch::RemoveProjectile(int32 Index)
+{
+	Positions.RemoveAtSwap(Index, 1, false);
+	Velocities.RemoveAtSwap(Index, 1, false);
+	Instigators.RemoveAtSwap(Index, 1, false);
+	Damages.RemoveAtSwap(Index, 1, false);
+	LifeRemaining.RemoveAtSwap(Index, 1, false);
+	Archetypes.RemoveAtSwap(Index, 1, false);
+	DEC_DWORD_STAT(STAT_TESTProjectileBatchInFlight);
+}
@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "Tickable.h"
+#include "TEST_ProjectileBatch.generated.h"
+
+class ATESTProjectile;
+class ATEST_ProjectileEvents;
+
+/**
+ * Lightweight projectiles simulated on server without actors.
+ * All projectiles in flight are stored in arrays and moved
+ * in one sweep pass per tick, only fire and impact are replicated
+ * by instigating character
+ */
+UCLASS()
+class TEST_API UTEST_ProjectileBatch : public UWorldSubsystem, public FTickableGameObject
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	// Add projectile to simulation, speed, damage, radius and life span
+	// are taken from ProjectileClass defaults. CatchUpTime is latency of
+	// shooting client, projectile first flies that time at once and is
+	// tested against characters rewound by UTEST_LagCompensation
+	void FireProjectile(TSubclassOf<ATESTProjectile> ProjectileClass, const FVector& Location, const FRotator& Rotation, APawn* Instigator, float CatchUpTime = 0.f);
+
+	// Number of projectiles in flight
+	int32 GetNumProjectiles() const { return Positions.Num(); }
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual ETickableTickType GetTickableTickType() const override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+	virtual UWorld* GetTickableGameObjectWorld() const override { return GetWorld(); }
+	// End of FTickableGameObject interface
+
+private:
+	// Move all projectiles and resolve hits
+	void StepProjectiles(float DeltaTime);
+
+	// Sweep projectile from its position, true if it hit something
+	bool SweepProjectile(int32 Index, const FVector& End, FHitResult& OutHit) const;
+
+	// Fly catch up segment of new projectile, true if it hit something
+	bool CatchUpProjectile(int32 Index, float CatchUpTime);
+
+	// Apply damage and notify hit actor, same as ATESTProjectile::OnBeginOverlap
+	void ResolveImpact(int32 Index, const FHitResult& Hit);
+
+	// Remove projectile, order of projectiles is not kept
+	void RemoveProjectile(int32 Index);
+
+	// Spawn world events actor on first shot so it is replicated before first impact
+	ATEST_ProjectileEvents* GetOrSpawnEvents();
+
+	// Projectiles data, one entry per projectile in every array
+	TArray<FVector> Positions;
+	TArray<FVector> Velocities;
+	TArray<TWeakObjectPtr<APawn>> Instigators;
+	TArray<float> Damages;
+	TArray<float> LifeRemaining;
+	// Defaults of fired class, classes are kept alive by characters
+	TArray<const ATESTProjectile*> Archetypes;
+
+	// Replicates impacts independently of instigating character
+	TWeakObjectPtr<ATEST_ProjectileEvents> Events;
+};
@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TEST_ProjectileEvents.h"
+#include "TESTProjectile.h"
+#include "TEST_ImpactEffects.h"
+#include "GameFramework/Pawn.h"
+#include "Engine/World.h"
+
+ATEST_ProjectileEvents::ATEST_ProjectileEvents()
+{
+	PrimaryActorTick.bCanEverTick = false;
+	bReplicates = true;
+	bAlwaysRelevant = true;
+	bReplicateMovement = false;
+	// Only RPCs are sent, there are no properties to check
+	NetUpdateFrequency = 1.f;
+	bCanBeDamaged = false;
+}
+
+void ATEST_ProjectileEvents::MulticastProjectileImpact_Implementation(TSubclassOf<ATESTProjectile> ProjectileClass, FVector_NetQuantize Location, APawn* Shooter)
+{
+	// Shooting client already played impact of predicted projectile
+	if (Shooter != nullptr && Shooter->IsLocallyControlled() && !Shooter->HasAuthority())
+	{
+		return;
+	}
+	if (ProjectileClass != nullptr)
+	{
+		UParticleSystem* HitParticle = ProjectileClass->GetDefaultObject<ATESTProjectile>()->GetHitParticle();
+		GetWorld()->GetSubsystem<UTEST_ImpactEffects>()->SpawnEmitter(HitParticle, Location);
+	}
+}
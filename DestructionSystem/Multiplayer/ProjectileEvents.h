@@ -0,0 +1,28 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "TEST_ProjectileEvents.generated.h"
+
+class ATESTProjectile;
+
+/**
+ * Always relevant actor replicating events of lightweight projectiles.
+ * One per world, spawned by UTEST_ProjectileBatch on server, so impact
+ * effects reach clients also after instigating character is gone
+ */
+UCLASS(NotPlaceable, Transient)
+class TEST_API ATEST_ProjectileEvents : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ATEST_ProjectileEvents();
+
+	// Play hit particle of projectile class on clients.
+	// Locally controlled Shooter skips it, it played predicted impact
+	UFUNCTION(NetMulticast, Unreliable)
+	void MulticastProjectileImpact(TSubclassOf<ATESTProjectile> ProjectileClass, FVector_NetQuantize Location, APawn* Shooter);
+};
@@ -0,0 +1,148 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TEST_ProjectilePool.h"
+#include "TESTProjectile.h"
+#include "Engine/World.h"
+
+DECLARE_STATS_GROUP(TEXT("TEST Projectile Pool"), STATGROUP_TESTProjectilePool, STATCAT_Advanced);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pooled projectiles"), STAT_TESTPooledProjectiles, STATGROUP_TESTProjectilePool);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Projectile spawns"), STAT_TESTProjectileSpawns, STATGROUP_TESTProjectilePool);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Projectile reuses"), STAT_TESTProjectileReuses, STATGROUP_TESTProjectilePool);
+
+void UTEST_ProjectilePool::Deinitialize()
+{
+	for (TPair<UClass*, FTEST_ProjectilePoolBucket>& Pair : Buckets)
+	{
+		DEC_DWORD_STAT_BY(STAT_TESTPooledProjectiles, Pair.Value.TotalSpawned);
+	}
+	Buckets.Empty();
+	Super::Deinitialize();
+}
+
+ATESTProjectile* UTEST_ProjectilePool::AcquireProjectile(TSubclassOf<ATESTProjectile> ProjectileClass, const FVector& Location, const FRotator& Rotation, AActor* Owner, APawn* Instigator)
+{
+	if (ProjectileClass == nullptr)
+	{
+		return nullptr;
+	}
+
+	FTEST_ProjectilePoolBucket& Bucket = Buckets.FindOrAdd(ProjectileClass);
+	if (Bucket.Free.Num() == 0)
+	{
+		// First use of class fills pool, later pool grows by steps
+		GrowPool(ProjectileClass, Bucket, Bucket.TotalSpawned == 0 ? InitialPoolSize : GrowSize);
+	}
+
+	ATESTProjectile* Projectile = nullptr;
+	while (Projectile == nullptr && Bucket.Free.Num() > 0)
+	{
+		Projectile = Bucket.Free.Pop(false);
+		if (!IsValid(Projectile))
+		{
+			Projectile = nullptr;
+		}
+	}
+
+	if (Projectile == nullptr)
+	{
+		// Pool is full, spawn projectile which destroy itself after hit
+		FActorSpawnParameters SpawnParameters;
+		SpawnParameters.Owner = Owner;
+		SpawnParameters.Instigator = Instigator;
+		INC_DWORD_STAT(STAT_TESTProjectileSpawns);
+		return GetWorld()->SpawnActor<ATESTProjectile>(ProjectileClass, Location, Rotation, SpawnParameters);
+	}
+
+	INC_DWORD_STAT(STAT_TESTProjectileReuses);
+	Projectile->SetOwner(Owner);
+	Projectile->Instigator = Instigator;
+	Projectile->ActivateFromPool(Location, Rotation);
+	return Projectile;
+}
+
+void UTEST_ProjectilePool::ReleaseProjectile(ATESTProjectile* Projectile)
+{
+	// Second release would put the same actor to free list twice
+	if (!IsValid(Projectile) || !Projectile->IsPooled() || !Projectile->IsLaunched())
+	{
+		return;
+	}
+	Projectile->DeactivateToPool();
+	Buckets.FindOrAdd(Projectile->GetClass()).Free.Push(Projectile);
+}
+
+void UTEST_ProjectilePool::RemoveDestroyedProjectile(ATESTProjectile* Projectile)
+{
+	FTEST_ProjectilePoolBucket* Bucket = Buckets.Find(Projectile->GetClass());
+	if (Bucket == nullptr || Bucket->TotalSpawned == 0)
+	{
+		return;
+	}
+	Bucket->Free.RemoveSingleSwap(Projectile, false);
+	Bucket->TotalSpawned--;
+	DEC_DWORD_STAT(STAT_TESTPooledProjectiles);
+}
+
+void UTEST_ProjectilePool::WarmPool(TSubclassOf<ATESTProjectile> ProjectileClass, int32 Count)
+{
+	if (ProjectileClass == nullptr)
+	{
+		return;
+	}
+	FTEST_ProjectilePoolBucket& Bucket = Buckets.FindOrAdd(ProjectileClass);
+	GrowPool(ProjectileClass, Bucket, Count - Bucket.Free.Num());
+}
+
+int32 UTEST_ProjectilePool::GetNumPooled(TSubclassOf<ATESTProjectile> ProjectileClass) const
+{
+	const FTEST_ProjectilePoolBucket* Bucket = Buckets.Find(ProjectileClass);
+	return Bucket ? Bucket->TotalSpawned : 0;
+}
+
+int32 UTEST_ProjectilePool::GetNumFree(TSubclassOf<ATESTProjectile> ProjectileClass) const
+{
+	const FTEST_ProjectilePoolBucket* Bucket = Buckets.Find(ProjectileClass);
+	return Bucket ? Bucket->Free.Num() : 0;
+}
+
+void UTEST_ProjectilePool::GrowPool(UClass* ProjectileClass, FTEST_ProjectilePoolBucket& Bucket, int32 Count)
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr || World->IsNetMode(NM_Client))
+	{
+		return;
+	}
+
+	if (MaxPoolSize > 0)
+	{
+		Count = FMath::Min(Count, MaxPoolSize - Bucket.TotalSpawned);
+	}
+	if (Count <= 0)
+	{
+		return;
+	}
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnParameters.bDeferConstruction = true;
+
+	Bucket.Free.Reserve(Bucket.Free.Num() + Count);
+	for (int32 i = 0; i < Count; ++i)
+	{
+		ATESTProjectile* Projectile = World->SpawnActor<ATESTProjectile>(ProjectileClass, FTransform::Identity, SpawnParameters);
+		if (Projectile == nullptr)
+		{
+			break;
+		}
+		// Mark as pooled before BeginPlay so it starts parked
+		Projectile->InitPooled(this);
+		Projectile->FinishSpawning(FTransform::Identity);
+		Projectile->SetNetDormancy(DORM_DormantAll);
+
+		Bucket.Free.Push(Projectile);
+		Bucket.TotalSpawned++;
+		INC_DWORD_STAT(STAT_TESTPooledProjectiles);
+		INC_DWORD_STAT(STAT_TESTProjectileSpawns);
+	}
+}
@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TEST_ProjectilePool.generated.h"
+
+class ATESTProjectile;
+
+// Free projectiles of one class
+USTRUCT()
+struct FTEST_ProjectilePoolBucket
+{
+	GENERATED_BODY()
+
+	// Parked projectiles ready to launch
+	UPROPERTY()
+	TArray<ATESTProjectile*> Free;
+
+	// Number of projectiles spawned for this class
+	int32 TotalSpawned = 0;
+};
+
+/**
+ * Server side pool of projectiles, reuse actors
+ * instead of spawn and destroy on every shot
+ */
+UCLASS(config=Game)
+class TEST_API UTEST_ProjectilePool : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	// Take projectile from pool and launch it, pool grows if empty.
+	// If pool reached MaxPoolSize projectile is spawned without pooling
+	ATESTProjectile* AcquireProjectile(TSubclassOf<ATESTProjectile> ProjectileClass, const FVector& Location, const FRotator& Rotation, AActor* Owner, APawn* Instigator);
+
+	// Park projectile and store it for next shot, parked projectile is ignored
+	void ReleaseProjectile(ATESTProjectile* Projectile);
+
+	// Called by pooled projectile destroyed outside of pool, frees its place
+	void RemoveDestroyedProjectile(ATESTProjectile* Projectile);
+
+	// Spawn projectiles before they are needed, e.g. on match start
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Projectile")
+	void WarmPool(TSubclassOf<ATESTProjectile> ProjectileClass, int32 Count);
+
+	// Projectiles of class owned by pool, flying or parked
+	int32 GetNumPooled(TSubclassOf<ATESTProjectile> ProjectileClass) const;
+
+	// Parked projectiles of class ready to launch
+	int32 GetNumFree(TSubclassOf<ATESTProjectile> ProjectileClass) const;
+
+	// Projectiles spawned on first use of class
+	UPROPERTY(config)
+	int32 InitialPoolSize = 32;
+
+	// Projectiles spawned every time pool is empty
+	UPROPERTY(config)
+	int32 GrowSize = 16;
+
+	// Max projectiles per class owned by pool, 0 means no limit
+	UPROPERTY(config)
+	int32 MaxPoolSize = 512;
+
+private:
+	// Spawn up to Count parked projectiles, respect MaxPoolSize
+	void GrowPool(UClass* ProjectileClass, FTEST_ProjectilePoolBucket& Bucket, int32 Count);
+
+	UPROPERTY(Transient)
+	TMap<UClass*, FTEST_ProjectilePoolBucket> Buckets;
+};
@@ -2,6 +2,11 @@
 
 #include "TESTCharacter.h"
 #include "TESTProjectile.h"
+#include "TEST_ProjectilePool.h"
+#include "TEST_ProjectileBatch.h"
+#include "TEST_ImpactEffects.h"
+#include "TEST_LagCompensation.h"
+#include "TEST_WeaponComponent.h"
 #include "Animation/AnimInstance.h"
 #include "Camera/CameraComponent.h"
 #include "Components/CapsuleComponent.h"
@@ -11,6 +16,9 @@
 #include "GameFramework/InputSettings.h"
 #include "Net/UnrealNetwork.h"
 #include "Engine/Engine.h"
+#include "Engine/Player.h"
+#include "GameFramework/GameNetworkManager.h"
+#include "GameFramework/PlayerController.h"
 #include "TimerManager.h"
 #include "HeadMountedDisplayFunctionLibrary.h"
 #include "Kismet/GameplayStatics.h"
@@ -31,6 +39,21 @@ DEFINE_LOG_CATEGORY_STATIC(LogFPChar, Warning, All);
 //////////////////////////////////////////////////////////////////////////
 // FPS Character, work online
 
+constexpr uint32 FTEST_PackedHealth::ValueBits;
+constexpr int32 FTEST_PackedHealth::MaxValue;
+
+bool FTEST_PackedHealth::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	uint32 PackedValue = FMath::Min<uint32>(Value, MaxValue);
+	Ar.SerializeInt(PackedValue, MaxValue + 1);
+	if (Ar.IsLoading())
+	{
+		Value = static_cast<uint16>(PackedValue);
+	}
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
+
 
 ATESTCharacter::ATESTCharacter()
 {
@@ -76,13 +99,11 @@ ATESTCharacter::ATESTCharacter()
 	FP_MuzzleLocation->SetupAttachment(FP_Gun);
 	FP_MuzzleLocation->SetRelativeLocation(FVector(0.0f, 70.0f, 2.5f));
 	
-	// Set start values for players
-	FireRate = 1.0f;
-	bIsFiringWeapon = false;
+	Weapon = CreateDefaultSubobject<UTEST_WeaponComponent>(TEXT("Weapon"));
 
+	// Set start values for players
 	MaxHealth = 100;
-	CurrentHealth = 50;
-	CurrentAmmo = 10;
+	CurrentHealth.Value = 50;
 }
 
 // Replicates variables
@@ -90,8 +111,10 @@ void ATESTCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLi
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME(ATESTCharacter, MaxHealth);
-	DOREPLIFETIME(ATESTCharacter, CurrentHealth);
+	// Max health is constant for character lifetime
+	DOREPLIFETIME_CONDITION(ATESTCharacter, MaxHealth, COND_InitialOnly);
+	// Only owner displays health on HUD
+	DOREPLIFETIME_CONDITION(ATESTCharacter, CurrentHealth, COND_OwnerOnly);
 }
 
 void ATESTCharacter::BeginPlay()
@@ -101,6 +124,21 @@ void ATESTCharacter::BeginPlay()
 
 	//Attach gun mesh component to Skeleton, doing it here because the skeleton is not yet created in the constructor
 	FP_Gun->AttachToComponent(Mesh1P, FAttachmentTransformRules(EAttachmentRule::SnapToTarget, true), TEXT("GripPoint"));
+
+	// Server keeps history of capsule for shots of lagging clients
+	if (HasAuthority())
+	{
+		GetWorld()->GetSubsystem<UTEST_LagCompensation>()->Register(this);
+	}
+}
+
+void ATESTCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UTEST_LagCompensation* LagCompensation = GetWorld()->GetSubsystem<UTEST_LagCompensation>())
+	{
+		LagCompensation->Unregister(this);
+	}
+	Super::EndPlay(EndPlayReason);
 }
 
 //////////////////////////////////////////////////////////////////////////
@@ -117,6 +155,7 @@ void ATESTCharacter::SetupPlayerInputComponent(class UInputComponent* PlayerInpu
 
 	// Bind fire event
 	PlayerInputComponent->BindAction("Fire", IE_Pressed, this, &ATESTCharacter::StartFire);
+	PlayerInputComponent->BindAction("Fire", IE_Released, this, &ATESTCharacter::StopFire);
 
 	// Bind movement events
 	PlayerInputComponent->BindAxis("MoveForward", this, &ATESTCharacter::MoveForward);
@@ -128,12 +167,12 @@ void ATESTCharacter::SetupPlayerInputComponent(class UInputComponent* PlayerInpu
 // Blueprints Functions
 int ATESTCharacter::GetAmmo()
 {
-	return CurrentAmmo;
+	return Weapon->GetAmmo();
 }
 
 int ATESTCharacter::GetHealth()
 {
-	return CurrentHealth;
+	return CurrentHealth.Value;
 }
 
 int ATESTCharacter::GetMaxHealth()
@@ -144,19 +183,46 @@ int ATESTCharacter::GetMaxHealth()
 
 void ATESTCharacter::StartFire()
 {
-	// Prevents too fast fire and if player have no ammo
-	if (!bIsFiringWeapon && CurrentAmmo != 0) {
-		bIsFiringWeapon = true;
+	Weapon->PressTrigger();
+	FireWeapon();
+}
+
+void ATESTCharacter::StopFire()
+{
+	Weapon->ReleaseTrigger();
+}
+
+void ATESTCharacter::FireWeapon()
+{
+	// Too many unacknowledged shots mean connection is lost
+	if (UnackedFireCommands.Num() >= MaxUnackedFireCommands)
+	{
+		return;
+	}
+	// Weapon checks fire rate and ammo
+	const float Now = Weapon->GetTime();
+	if (Weapon->TryFire(Now)) {
 		UWorld* World = GetWorld();
-		// Set timer to next fire
-		World->GetTimerManager().SetTimer(FiringTimer, this, &ATESTCharacter::StopFire, FireRate, false);
-		OnFire();
-		CurrentAmmo--;
-		// try and play the sound if specified
-		if (FireSound != NULL)
+
+		FTEST_FireCommand Command;
+		Command.Sequence = NextFireSequence++;
+		Command.MuzzleLocation = FP_MuzzleLocation->GetComponentLocation();
+		Command.Direction = GetControlRotation().Vector();
+		Command.ClientTime = Now;
+		if (HasAuthority())
+		{
+			// Listen server fires directly, weapon already took ammo
+			OnFire(Command);
+		}
+		else
 		{
-			UGameplayStatics::PlaySoundAtLocation(this, FireSound, GetActorLocation());
+			// Predict shot and send it with next batch
+			UnackedFireCommands.Add(Command);
+			bHasNewFireCommands = true;
+			SpawnPredictedProjectile(Command.MuzzleLocation, GetControlRotation());
 		}
+		// try and play the sound if specified
+		World->GetSubsystem<UTEST_ImpactEffects>()->PlaySound(FireSound, GetActorLocation());
 
 		// try and play a firing animation if specified
 		if (FireAnimation != NULL)
@@ -171,35 +237,158 @@ void ATESTCharacter::StartFire()
 	}
 }
 
-// Prevents too fast fire
-void ATESTCharacter::StopFire()
+void ATESTCharacter::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+	// Auto fire and burst shots after cooldown
+	if (IsLocallyControlled() && Weapon->HasPendingShots())
+	{
+		FireWeapon();
+	}
+	if (UnackedFireCommands.Num() > 0)
+	{
+		SendFireCommands();
+	}
+}
+
+void ATESTCharacter::SendFireCommands()
+{
+	// New shots wait for next send at movement rate, shots of frames in between share one RPC
+	const float Now = GetWorld()->GetTimeSeconds();
+	const float SinceLastBatch = Now - LastFireBatchTime;
+	if ((bHasNewFireCommands && SinceLastBatch >= GetFireBatchInterval()) || SinceLastBatch >= FireResendInterval)
+	{
+		ServerFireBatch(UnackedFireCommands);
+		bHasNewFireCommands = false;
+		LastFireBatchTime = Now;
+	}
+}
+
+float ATESTCharacter::GetFireBatchInterval() const
 {
-	bIsFiringWeapon = false;
+	// Same rate as character movement sends moves, slower on slow connections
+	const AGameNetworkManager* NetworkManager = GetDefault<AGameNetworkManager>();
+	const APlayerController* PlayerController = Cast<APlayerController>(GetController());
+	const UPlayer* Player = PlayerController != nullptr ? PlayerController->Player : nullptr;
+	if (Player != nullptr && Player->CurrentNetSpeed <= NetworkManager->ClientNetSendMoveThrottleAtNetSpeed)
+	{
+		return NetworkManager->ClientNetSendMoveDeltaTimeThrottled;
+	}
+	return NetworkManager->ClientNetSendMoveDeltaTime;
+}
+
+void ATESTCharacter::SpawnPredictedProjectile(const FVector& Location, const FRotator& Rotation)
+{
+	if (ProjectileClass == NULL)
+	{
+		return;
+	}
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.Owner = this;
+	SpawnParameters.Instigator = this;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnParameters.bDeferConstruction = true;
+	ATESTProjectile* Projectile = GetWorld()->SpawnActor<ATESTProjectile>(ProjectileClass, Location, Rotation, SpawnParameters);
+	if (Projectile != NULL)
+	{
+		Projectile->InitPredicted();
+		Projectile->FinishSpawning(FTransform(Rotation, Location));
+	}
+}
+
+void ATESTCharacter::ServerFireBatch_Implementation(const TArray<FTEST_FireCommand>& Commands)
+{
+	// Client never has more unacknowledged shots, bigger batch is not from this game
+	if (Commands.Num() > MaxUnackedFireCommands)
+	{
+		UE_LOG(LogFPChar, Warning, TEXT("%s sent %d fire commands, limit is %d, batch rejected"), *GetName(), Commands.Num(), MaxUnackedFireCommands);
+		return;
+	}
+
+	const float ServerTime = Weapon->GetTime();
+	const float MaxRewindTime = GetWorld()->GetSubsystem<UTEST_LagCompensation>()->MaxRewindTime;
+
+	// Resent commands are already processed, only newer ones fire
+	for (const FTEST_FireCommand& Command : Commands)
+	{
+		if (!IsNewerFireSequence(Command.Sequence, LastProcessedFireSequence))
+		{
+			continue;
+		}
+		LastProcessedFireSequence = Command.Sequence;
+
+		// Server owns ammo and fire rate, rejected shot is corrected by ack.
+		// Accepted time is never before cooldown of last accepted shot
+		FTEST_FireCommand AcceptedCommand = Command;
+		if (Weapon->ValidateShot(Command.ClientTime, ServerTime, AcceptedCommand.ClientTime))
+		{
+			// Rewind no further than lag compensation window
+			AcceptedCommand.ClientTime = FMath::Max(AcceptedCommand.ClientTime, ServerTime - MaxRewindTime);
+			OnFire(AcceptedCommand);
+		}
+	}
+	ClientAckFire(LastProcessedFireSequence, Weapon->GetAmmo());
+}
+
+void ATESTCharacter::ClientAckFire_Implementation(uint16 AckedSequence, int32 ServerAmmo)
+{
+	UnackedFireCommands.RemoveAll([AckedSequence](const FTEST_FireCommand& Command)
+	{
+		return !IsNewerFireSequence(Command.Sequence, AckedSequence);
+	});
+	// Server ammo without shots it did not see yet
+	Weapon->SetAmmo(ServerAmmo - UnackedFireCommands.Num());
 }
 
 // Server fire function
-void ATESTCharacter::OnFire_Implementation()
+void ATESTCharacter::OnFire(const FTEST_FireCommand& Command)
 {
 	// try and fire a projectile
 	if (ProjectileClass != NULL)
 	{
 		UWorld* const World = GetWorld();
 		if (World != NULL)
-		{	// Set spawn location, rotation and parameters to projectile fired by player
+		{	// Set spawn location, rotation and parameters to projectile fired by player.
+			// Shot goes from where client saw it, if it is close to server muzzle
 			FVector spawnLocation = FP_MuzzleLocation->GetComponentLocation();
-			FRotator spawnRotation = GetControlRotation();
+			if (FVector::DistSquared(Command.MuzzleLocation, spawnLocation) <= FMath::Square(MaxMuzzleError))
+			{
+				spawnLocation = Command.MuzzleLocation;
+			}
+			FRotator spawnRotation = Command.Direction.IsNearlyZero() ? GetControlRotation() : Command.Direction.Rotation();
 
-			FActorSpawnParameters spawnParameters;
-			spawnParameters.Instigator = Instigator;
-			spawnParameters.Owner = this;
-			FCollisionQueryParams CollisionParams;
+			// Projectile catches up client latency against rewound characters
+			UTEST_LagCompensation* LagCompensation = World->GetSubsystem<UTEST_LagCompensation>();
+			const float CatchUpTime = LagCompensation->ClampRewindTime(LagCompensation->GetServerTime() - Command.ClientTime);
 
-			// Spawn Projectile on all clients
-			ATESTProjectile* spawnedProjectile = GetWorld()->SpawnActor<ATESTProjectile>(spawnLocation, spawnRotation, spawnParameters);
+			if (bUseLightweightProjectiles)
+			{
+				// Simulate projectile only on server, clients get fire and impact events
+				World->GetSubsystem<UTEST_ProjectileBatch>()->FireProjectile(ProjectileClass, spawnLocation, spawnRotation, this, CatchUpTime);
+				MulticastProjectileFired(spawnLocation);
+				return;
+			}
+
+			// Take projectile from pool, it is replicated to all clients
+			UTEST_ProjectilePool* ProjectilePool = World->GetSubsystem<UTEST_ProjectilePool>();
+			ATESTProjectile* spawnedProjectile = ProjectilePool->AcquireProjectile(ProjectileClass, spawnLocation, spawnRotation, this, Instigator);
+			if (spawnedProjectile != nullptr)
+			{
+				spawnedProjectile->CatchUp(CatchUpTime);
+			}
 		}
 	}
 }
 
+void ATESTCharacter::MulticastProjectileFired_Implementation(FVector_NetQuantize Origin)
+{
+	// Shooting player already played sound in StartFire
+	if (!IsLocallyControlled())
+	{
+		GetWorld()->GetSubsystem<UTEST_ImpactEffects>()->PlaySound(FireSound, Origin);
+	}
+}
+
 void ATESTCharacter::MoveForward(float Value)
 {
 	if (Value != 0.0f)
@@ -221,15 +410,15 @@ void ATESTCharacter::MoveRight(float Value)
 // Decrease Health after hit
 float ATESTCharacter::TakeDamage(float DamageTaken, FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser)
 {
-	UpdateHealth(-DamageTaken);
-	return DamageTaken;
+	// Engine scales radial damage by distance
+	const float ActualDamage = Super::TakeDamage(DamageTaken, DamageEvent, EventInstigator, DamageCauser);
+	UpdateHealth(-ActualDamage);
+	return ActualDamage;
 }
 
 void ATESTCharacter::UpdateHealth(int HealthChange)
 {
-		// Increase or decrease current health
-		CurrentHealth += HealthChange;
-		// Prevents to overlap health values
-		if (CurrentHealth < 0) { CurrentHealth = 0; }
-		if (CurrentHealth > MaxHealth) { CurrentHealth = 100; }
+	// Increase or decrease current health, prevents to overlap health values
+	const int MaxValue = FMath::Min(MaxHealth, FTEST_PackedHealth::MaxValue);
+	CurrentHealth.Value = static_cast<uint16>(FMath::Clamp(CurrentHealth.Value + HealthChange, 0, MaxValue));
 }
\ No newline at end of file
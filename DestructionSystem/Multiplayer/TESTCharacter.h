@@ -9,6 +9,60 @@
 
 class UInputComponent;
 
+// One shot predicted by client, sent unreliably until server acknowledges it
+USTRUCT()
+struct FTEST_FireCommand
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	uint16 Sequence = 0;
+
+	UPROPERTY()
+	FVector_NetQuantize MuzzleLocation;
+
+	UPROPERTY()
+	FVector_NetQuantizeNormal Direction;
+
+	// Server time seen by client when shot was fired
+	UPROPERTY()
+	float ClientTime = 0.f;
+};
+
+/**
+ * Current health of character packed to 10 bits,
+ * replicated only to owning player
+ */
+USTRUCT()
+struct FTEST_PackedHealth
+{
+	GENERATED_BODY()
+
+	// Health is sent with this many bits
+	static constexpr uint32 ValueBits = 10;
+	static constexpr int32 MaxValue = (1 << ValueBits) - 1;
+
+	UPROPERTY()
+	uint16 Value = 0;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+
+	bool operator==(const FTEST_PackedHealth& Other) const
+	{
+		return Value == Other.Value;
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FTEST_PackedHealth> : public TStructOpsTypeTraitsBase2<FTEST_PackedHealth>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithIdenticalViaEquality = true,
+	};
+};
+
 UCLASS(config=Game)
 class ATESTCharacter : public ACharacter
 {
@@ -33,6 +87,10 @@ class ATESTCharacter : public ACharacter
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
 	class UCameraComponent* FirstPersonCameraComponent;
 
+	// Ammo, fire rate and fire mode
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Weapon, meta = (AllowPrivateAccess = "true"))
+	class UTEST_WeaponComponent* Weapon;
+
 public:
 	
 	ATESTCharacter();
@@ -42,6 +100,8 @@ public:
 protected:
 	virtual void BeginPlay();
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:
 	/** Base turn rate, in deg/sec. Other scaling may affect final turn rate. */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category=Camera)
@@ -59,6 +119,15 @@ public:
 	UPROPERTY(EditDefaultsOnly, Category=Projectile)
 	TSubclassOf<class ATESTProjectile> ProjectileClass;
 
+	// Simulate projectiles in UTEST_ProjectileBatch instead of
+	// spawning replicated projectile actor for every shot
+	UPROPERTY(EditDefaultsOnly, Category=Projectile)
+	bool bUseLightweightProjectiles = false;
+
+	// Largest accepted distance between muzzle sent by client and muzzle on server
+	UPROPERTY(EditDefaultsOnly, Category=Projectile)
+	float MaxMuzzleError = 100.f;
+
 	/** Sound to play each time we fire */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Gameplay)
 	class USoundBase* FireSound;
@@ -87,19 +156,67 @@ public:
 	UFUNCTION(BlueprintPure)
 	FString GetBackpackItemName();
 
-	// Amount of character ammunition
-	int CurrentAmmo;
+	// Play fire sound on other clients, used by lightweight projectiles.
+	// Impacts are sent by ATEST_ProjectileEvents
+	UFUNCTION(NetMulticast, Unreliable)
+	void MulticastProjectileFired(FVector_NetQuantize Origin);
 protected:
-	// Start fire on client to play sound and invoke 
-	// to server function after press fire
+	// Press and release weapon trigger
 	void StartFire();
-	
-	// Sets a flag that prohibits the player from shooting
 	void StopFire();
 
-	// Server spawn projectile after shoot
-	UFUNCTION(Server, Reliable)
-	void OnFire();
+	// Fire shot wanted by weapon on client to play sound and
+	// invoke server function, called on press and every frame
+	void FireWeapon();
+
+	// Server spawn projectile after shoot. Client sends muzzle and aim
+	// it saw and server time of shot, used for lag compensation
+	void OnFire(const FTEST_FireCommand& Command);
+
+	// Fire commands not acknowledged by server, resent with every batch.
+	// Unreliable so lost packets do not stall reliable buffer under automatic fire
+	UFUNCTION(Server, Unreliable)
+	void ServerFireBatch(const TArray<FTEST_FireCommand>& Commands);
+
+	// Last processed fire sequence and server ammo, client drops
+	// acknowledged commands and corrects predicted ammo
+	UFUNCTION(Client, Unreliable)
+	void ClientAckFire(uint16 AckedSequence, int32 ServerAmmo);
+
+	// Send unacknowledged fire commands, new ones with next batch, old ones
+	// again after FireResendInterval
+	void SendFireCommands();
+
+	// Time between batches of new fire commands
+	float GetFireBatchInterval() const;
+
+	// Local projectile without gameplay, hides latency of server projectile
+	void SpawnPredictedProjectile(const FVector& Location, const FRotator& Rotation);
+
+	// True if sequence A was issued after B, handles wrap around
+	static bool IsNewerFireSequence(uint16 A, uint16 B) { return static_cast<int16>(A - B) > 0; }
+
+	// Client only, predicted shots waiting for acknowledge
+	TArray<FTEST_FireCommand> UnackedFireCommands;
+
+	uint16 NextFireSequence = 1;
+
+	bool bHasNewFireCommands = false;
+
+	float LastFireBatchTime = 0.f;
+
+	// Server only, last fire command processed
+	uint16 LastProcessedFireSequence = 0;
+
+	// Unacknowledged shots above this are not predicted
+	UPROPERTY(EditDefaultsOnly, Category=Projectile)
+	int32 MaxUnackedFireCommands = 16;
+
+	// Resend interval of unacknowledged fire commands
+	UPROPERTY(EditDefaultsOnly, Category=Projectile)
+	float FireResendInterval = 0.1f;
+
+	virtual void Tick(float DeltaSeconds) override;
 
 	/** Handles moving forward/backward */
 	void MoveForward(float Val);
@@ -107,25 +224,19 @@ protected:
 	/** Handles stafing movement, left and right */
 	void MoveRight(float Val);
 
-	// Set time to next fire
-	float FireRate;
-
-	// Flag that give posibility to shoot
-	bool bIsFiringWeapon;
-	FTimerHandle FiringTimer;
-
 	// If player take damage reduce his health
 	UFUNCTION(BlueprintCallable)
 	float TakeDamage(float DamageTaken, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser) override;
 
-	// Character starting and max health value 
+	// Character max health value, sent only once so changes
+	// after spawn are not seen by clients. Limited to 1023
 	UPROPERTY(Replicated, EditAnywhere, BlueprintReadWrite)
 	int MaxHealth = 100;
 
 private:
 	// Character current health
 	UPROPERTY(Replicated, VisibleAnywhere)
-	int CurrentHealth = 50;
+	FTEST_PackedHealth CurrentHealth;
 
 protected:
 	// APawn interface
@@ -136,6 +247,8 @@ public:
 	FORCEINLINE class USkeletalMeshComponent* GetMesh1P() const { return Mesh1P; }
 	/** Returns FirstPersonCameraComponent subobject **/
 	FORCEINLINE class UCameraComponent* GetFirstPersonCameraComponent() const { return FirstPersonCameraComponent; }
+	/** Returns Weapon subobject **/
+	FORCEINLINE class UTEST_WeaponComponent* GetWeapon() const { return Weapon; }
 	
 	// Update player health level
 	// HealtgChange this is the amout to change health by, can be + or -
@@ -7,10 +7,15 @@
 #include "Components/StaticMeshComponent.h"
 #include "Kismet/GameplayStatics.h"
 #include "Components/SphereComponent.h"
+#include "Net/UnrealNetwork.h"
+#include "TEST_ProjectilePool.h"
+#include "TEST_ImpactEffects.h"
+#include "TEST_LagCompensation.h"
 
 ATESTProjectile::ATESTProjectile() 
 {
 	bReplicates = true;
+	InteractionCapabilities |= ETESTInteractionCapability::Projectile;
 	// Use a sphere as a simple collision representation
 	CollisionComp = CreateDefaultSubobject<USphereComponent>(TEXT("SphereComp"));
 	CollisionComp->InitSphereRadius(5.0f);
@@ -59,19 +64,199 @@ ATESTProjectile::ATESTProjectile()
 
 void ATESTProjectile::OnBeginOverlap(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
 {
-	if ((OtherActor != NULL) && (OtherActor != this) && (OtherComp != NULL))
+	// Predicted projectile only shows impact, server does the gameplay
+	if (bPredicted)
+	{
+		ReleaseOrDestroy();
+		return;
+	}
+	// Parked projectile can still get hits queued in the same frame
+	if (OwningPool != nullptr && !PoolState.bActive)
+	{
+		return;
+	}
+	if (bExplosive)
+	{
+		// Hit actor is damaged by explosion as everything around
+		GetWorld()->GetSubsystem<UTEST_RadialDamage>()->ApplyExplosion(Hit.Location, Damage, Explosion, DamageType, GetInstigatorController(), this);
+	}
+	else if ((OtherActor != NULL) && (OtherActor != this) && (OtherComp != NULL))
 	{
 		if (OtherComp->IsSimulatingPhysics())
 		{
 			OtherComp->AddImpulseAtLocation(GetVelocity() * 100.0f, GetActorLocation());
 		}
-		UGameplayStatics::ApplyPointDamage(OtherActor, Damage, NormalImpulse, Hit, Instigator->Controller, this, DamageType);
+		UGameplayStatics::ApplyPointDamage(OtherActor, Damage, NormalImpulse, Hit, GetInstigatorController(), this, DamageType);
 	}	
-	Destroy();
+	ReleaseOrDestroy();
+}
+
+void ATESTProjectile::CatchUp(float CatchUpTime)
+{
+	if (CatchUpTime <= 0.f)
+	{
+		return;
+	}
+	UTEST_LagCompensation* LagCompensation = GetWorld()->GetSubsystem<UTEST_LagCompensation>();
+	const FVector Start = GetActorLocation();
+	const FVector End = Start + ProjectileMovement->Velocity * CatchUpTime;
+	FHitResult Hit;
+	if (LagCompensation->SweepRewound(Start, End, CollisionComp, LagCompensation->GetServerTime() - CatchUpTime, Instigator, Hit))
+	{
+		SetActorLocation(Hit.Location, false, nullptr, ETeleportType::TeleportPhysics);
+		OnBeginOverlap(CollisionComp, Hit.GetActor(), Hit.GetComponent(), FVector::ZeroVector, Hit);
+		return;
+	}
+	SetActorLocation(End, false, nullptr, ETeleportType::TeleportPhysics);
+}
+
+// Replicates variables
+void ATESTProjectile::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(ATESTProjectile, PoolState);
+}
+
+void ATESTProjectile::BeginPlay()
+{
+	Super::BeginPlay();
+	// Pooled projectile is spawned parked, pool launches it later
+	if (PoolState.bPooled && !PoolState.bActive)
+	{
+		ApplyPoolState(false);
+	}
+	// Projectile spawned when pool was full is not seen by shooter either
+	else if (!PoolState.bPooled && IsPredictedByShooter())
+	{
+		SetActorHiddenInGame(true);
+		SetActorEnableCollision(false);
+	}
+}
+
+void ATESTProjectile::InitPooled(UTEST_ProjectilePool* InOwningPool)
+{
+	OwningPool = InOwningPool;
+	PoolState.bPooled = true;
+	PoolState.bActive = false;
+}
+
+void ATESTProjectile::ActivateFromPool(const FVector& Location, const FRotator& Rotation)
+{
+	// Wake up before changing state so clients receive the launch
+	SetNetDormancy(DORM_Awake);
+
+	PoolState.bActive = true;
+	PoolState.LaunchCount++;
+	PoolState.Location = Location;
+	PoolState.Rotation = Rotation;
+	ApplyPoolState(true);
+
+	// Restart life span from class default
+	SetLifeSpan(GetClass()->GetDefaultObject<ATESTProjectile>()->InitialLifeSpan);
+	ForceNetUpdate();
+}
+
+void ATESTProjectile::DeactivateToPool()
+{
+	PoolState.bActive = false;
+	PoolState.Location = GetActorLocation();
+	ApplyPoolState(true);
+
+	SetLifeSpan(0.f);
+	// Send last state and stop considering projectile for replication
+	ForceNetUpdate();
+	SetNetDormancy(DORM_DormantAll);
+}
+
+void ATESTProjectile::ReleaseOrDestroy()
+{
+	if (OwningPool != nullptr)
+	{
+		// Several hits can arrive before collision is disabled
+		if (PoolState.bActive)
+		{
+			OwningPool->ReleaseProjectile(this);
+		}
+	}
+	else
+	{
+		Destroy();
+	}
+}
+
+void ATESTProjectile::OnRep_PoolState()
+{
+	ApplyPoolState(true);
+}
+
+void ATESTProjectile::ApplyPoolState(bool bPlayEffects)
+{
+	const bool bPredictedByShooter = IsPredictedByShooter();
+
+	if (PoolState.bActive)
+	{
+		SetActorLocationAndRotation(PoolState.Location, PoolState.Rotation, false, nullptr, ETeleportType::ResetPhysics);
+		SetActorHiddenInGame(bPredictedByShooter);
+		SetActorEnableCollision(!bPredictedByShooter);
+		// Movement component drops updated component after stop, set it again
+		ProjectileMovement->SetUpdatedComponent(CollisionComp);
+		ProjectileMovement->Velocity = PoolState.Rotation.Vector() * ProjectileMovement->InitialSpeed;
+		ProjectileMovement->Activate(true);
+		bInFlight = true;
+	}
+	else
+	{
+		ProjectileMovement->StopMovementImmediately();
+		ProjectileMovement->Deactivate();
+		SetActorEnableCollision(false);
+		SetActorHiddenInGame(true);
+		// Play hit effect only if this machine saw projectile flying
+		if (bPlayEffects && bInFlight && !bPredictedByShooter)
+		{
+			SpawnHitEffect(PoolState.Location);
+		}
+		bInFlight = false;
+	}
+}
+
+bool ATESTProjectile::IsPredictedByShooter() const
+{
+	const APawn* Shooter = Cast<APawn>(GetOwner());
+	return GetLocalRole() != ROLE_Authority && Shooter != nullptr && Shooter->IsLocallyControlled();
+}
+
+void ATESTProjectile::SpawnHitEffect(const FVector& Location)
+{
+	GetWorld()->GetSubsystem<UTEST_ImpactEffects>()->SpawnEmitter(HitParticle, Location);
+}
+
+void ATESTProjectile::LifeSpanExpired()
+{
+	// Pool decide about pooled projectiles, clients wait for replicated state
+	if (PoolState.bPooled)
+	{
+		if (GetLocalRole() == ROLE_Authority)
+		{
+			ReleaseOrDestroy();
+		}
+		return;
+	}
+	Super::LifeSpanExpired();
 }
 
 void ATESTProjectile::Destroyed()
 {
-	FVector spawnLocation = GetActorLocation();
-	UGameplayStatics::SpawnEmitterAtLocation(this, HitParticle, spawnLocation, FRotator::ZeroRotator, true, EPSCPoolMethod::AutoRelease);
+	// Pooled projectiles play effect on return to pool, shooter saw its predicted one
+	if (!PoolState.bPooled && !IsPredictedByShooter())
+	{
+		SpawnHitEffect(GetActorLocation());
+	}
+	// Pooled projectile destroyed by someone else no longer counts to pool size
+	if (OwningPool != nullptr)
+	{
+		OwningPool->RemoveDestroyedProjectile(this);
+		OwningPool = nullptr;
+	}
+	Super::Destroyed();
 }
\ No newline at end of file
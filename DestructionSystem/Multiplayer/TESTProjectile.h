@@ -5,10 +5,39 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "Particles/ParticleSystemComponent.h"
+#include "TEST_InteractionCapabilities.h"
+#include "TEST_RadialDamage.h"
 #include "TESTProjectile.generated.h"
 
+// State of pooled projectile replicated to clients,
+// every launch from pool and every return is one change
+USTRUCT()
+struct FTEST_ProjectilePoolState
+{
+	GENERATED_BODY()
+
+	// Projectile is owned by UTEST_ProjectilePool
+	UPROPERTY()
+	bool bPooled = false;
+
+	// Projectile is flying, false when parked in pool
+	UPROPERTY()
+	bool bActive = false;
+
+	// Incremented on every launch so reuse is always replicated
+	UPROPERTY()
+	uint8 LaunchCount = 0;
+
+	// Launch location, or impact location after return to pool
+	UPROPERTY()
+	FVector_NetQuantize Location;
+
+	UPROPERTY()
+	FRotator Rotation;
+};
+
 UCLASS(config=Game)
-class ATESTProjectile : public AActor
+class ATESTProjectile : public ATEST_CapabilityActor
 {
 	GENERATED_BODY()
 
@@ -38,17 +67,86 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly)
 	float Damage;
 
+	// Explode on impact, Damage is dealt to everything in radius
+	UPROPERTY(EditAnywhere, BlueprintReadOnly)
+	bool bExplosive = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta = (EditCondition = "bExplosive"))
+	FTEST_ExplosionParams Explosion;
+
 	/** called when projectile hits something */
 	UFUNCTION(Category = "Projectile")
 	void OnBeginOverlap(UPrimitiveComponent* HitComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
 
+	// Launch projectile taken from pool
+	void ActivateFromPool(const FVector& Location, const FRotator& Rotation);
+
+	// Move launched projectile forward by client latency on server, against
+	// world as it is now and characters as shooting client saw them
+	void CatchUp(float CatchUpTime);
+
+	// Hide projectile, stop movement and make it dormant until next launch
+	void DeactivateToPool();
+
+	// Mark projectile as owned by pool, called before BeginPlay
+	void InitPooled(class UTEST_ProjectilePool* InOwningPool);
+
+	// Return to pool if pooled, otherwise destroy
+	void ReleaseOrDestroy();
+
+	// Owned by UTEST_ProjectilePool
+	bool IsPooled() const { return PoolState.bPooled; }
+
+	// Launched from pool and not returned yet
+	bool IsLaunched() const { return PoolState.bActive; }
+
+	// Mark as local cosmetic projectile of shooting client, called before BeginPlay.
+	// It does no damage and is destroyed on first hit
+	void InitPredicted() { bPredicted = true; }
+
+	// Required network setup
+	void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
 	/** Returns CollisionComp subobject **/
 	FORCEINLINE class USphereComponent* GetCollisionComp() const { return CollisionComp; }
 	/** Returns ProjectileMovement subobject **/
 	FORCEINLINE class UProjectileMovementComponent* GetProjectileMovement() const { return ProjectileMovement; }
+	/** Returns HitParticle **/
+	FORCEINLINE class UParticleSystem* GetHitParticle() const { return HitParticle; }
 
 protected:
+	virtual void BeginPlay() override;
+
 	// Spawn emmiter at point of object destruction
 	virtual void Destroyed() override;
+
+	// Pooled projectiles go back to pool instead of being destroyed
+	virtual void LifeSpanExpired() override;
+
+private:
+	// Replicated pool state, drives activation on clients
+	UPROPERTY(ReplicatedUsing = OnRep_PoolState)
+	FTEST_ProjectilePoolState PoolState;
+
+	UFUNCTION()
+	void OnRep_PoolState();
+
+	// Apply PoolState locally: launch or park projectile
+	void ApplyPoolState(bool bPlayEffects);
+
+	// Replicated copy on client which fired it, client shows its predicted projectile instead
+	bool IsPredictedByShooter() const;
+
+	// Spawn HitParticle at given location
+	void SpawnHitEffect(const FVector& Location);
+
+	bool bPredicted = false;
+
+	// Pool which owns this projectile, only valid on server
+	UPROPERTY(Transient)
+	class UTEST_ProjectilePool* OwningPool;
+
+	// Projectile is currently flying on this machine
+	bool bInFlight = false;
 };
 
@@ -0,0 +1,125 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "TESTAutomationWorld.h"
+#include "TESTNetTestSession.h"
+#include "TESTNetBandwidth.h"
+#include "TESTCharacter.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace TESTCharacterBandwidthTest
+{
+	const float DeltaTime = 1.f / 60.f;
+
+	FTEST_PackedHealth MakeHealth(uint16 Value)
+	{
+		FTEST_PackedHealth Health;
+		Health.Value = Value;
+		return Health;
+	}
+
+	// Character of every client standing still next to others, so all are relevant to all
+	TArray<ATESTCharacter*> SpawnPossessedCharacters(UWorld* World, FTEST_NetTestSession& Session)
+	{
+		TArray<ATESTCharacter*> Characters;
+		for (int32 Client = 0; Client < Session.NumClients(); ++Client)
+		{
+			const FVector Location((Client % 8) * 200.f, (Client / 8) * 200.f, 0.f);
+			ATESTCharacter* Character = World->SpawnActor<ATESTCharacter>(Location, FRotator::ZeroRotator);
+			Character->GetCharacterMovement()->DisableMovement();
+			Session.GetPlayerController(Client)->Possess(Character);
+			Session.SetViewLocation(Client, Location);
+			Characters.Add(Character);
+		}
+		return Characters;
+	}
+
+	// Hit and heal, health changes and returns
+	void ChangeHealth(ATESTCharacter* Character, int32 Frame)
+	{
+		Character->UpdateHealth(Frame % 2 == 0 ? -1 : 1);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTESTCharacterHealthPackingTest, "TEST.Character.HealthPacking", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTESTCharacterHealthPackingTest::RunTest(const FString& Parameters)
+{
+	using namespace TESTCharacterBandwidthTest;
+
+	FTEST_PackedHealth Received;
+	TestEqual(TEXT("Packed health bits"), TESTNetBandwidth::RoundTrip(MakeHealth(50), Received), static_cast<int64>(FTEST_PackedHealth::ValueBits));
+	TestEqual(TEXT("Health survives packing"), static_cast<int32>(Received.Value), 50);
+	TESTNetBandwidth::RoundTrip(MakeHealth(FTEST_PackedHealth::MaxValue), Received);
+	TestEqual(TEXT("Max health survives packing"), static_cast<int32>(Received.Value), FTEST_PackedHealth::MaxValue);
+	TESTNetBandwidth::RoundTrip(MakeHealth(2000), Received);
+	TestEqual(TEXT("Health above range is clamped"), static_cast<int32>(Received.Value), FTEST_PackedHealth::MaxValue);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTESTCharacterHealthBandwidthBenchmark, "TEST.Character.HealthBandwidth", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FTESTCharacterHealthBandwidthBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace TESTCharacterBandwidthTest;
+	using namespace TESTNetBandwidth;
+
+	const int32 NumClients = 64;
+	const int32 WarmupFrames = 30;
+	const int32 NumFrames = 60;
+
+	FTEST_AutomationWorld World;
+	FTEST_NetTestSession Session(World.Get(), NumClients);
+	if (!TestTrue(TEXT("Server listens with simulated clients"), Session.IsListening()))
+	{
+		return false;
+	}
+	TArray<ATESTCharacter*> Characters = SpawnPossessedCharacters(World.Get(), Session);
+	for (int32 Frame = 0; Frame < WarmupFrames; ++Frame)
+	{
+		World.Tick(DeltaTime);
+		Session.Tick(DeltaTime);
+	}
+
+	// Same number of frames for every run, so packet headers and keep alives cancel out
+	const TArray<int64> IdleBytes = MeasureClientBytes(World, Session, NumFrames, DeltaTime, [](int32 Frame) {});
+	const TArray<int64> OneChangingBytes = MeasureClientBytes(World, Session, NumFrames, DeltaTime, [&Characters](int32 Frame)
+	{
+		ChangeHealth(Characters[0], Frame);
+	});
+	const TArray<int64> AllChangingBytes = MeasureClientBytes(World, Session, NumFrames, DeltaTime, [&Characters](int32 Frame)
+	{
+		for (ATESTCharacter* Character : Characters)
+		{
+			ChangeHealth(Character, Frame);
+		}
+	});
+
+	// Owner of changing character gets its health, others get nothing more
+	const int64 OwnerBytes = GetExtraBytes(OneChangingBytes, IdleBytes, 0);
+	int64 OtherBytes = 0;
+	int64 AllBytes = 0;
+	for (int32 Client = 0; Client < NumClients; ++Client)
+	{
+		OtherBytes += Client > 0 ? GetExtraBytes(OneChangingBytes, IdleBytes, Client) : 0;
+		AllBytes += GetExtraBytes(AllChangingBytes, IdleBytes, Client);
+	}
+	const double OtherBytesPerClient = static_cast<double>(OtherBytes) / (NumClients - 1);
+	const double AllBytesPerClient = static_cast<double>(AllBytes) / NumClients;
+
+	TestTrue(TEXT("Owner gets health changes"), OwnerBytes > 0);
+	TestTrue(TEXT("Other clients do not get health of character they do not own"), OtherBytesPerClient < OwnerBytes);
+	// Replicated to everyone, every client would get changes of all characters
+	TestTrue(TEXT("Client traffic does not grow with number of changing characters"), AllBytesPerClient < OwnerBytes * 2.0);
+
+	const float Seconds = NumFrames * DeltaTime;
+	AddInfo(FString::Printf(TEXT("%d clients, health changes every frame, bytes/s over idle: owner of one changing character %.0f, other clients %.1f, every client with all %d changing %.0f"),
+		NumClients, OwnerBytes / Seconds, OtherBytesPerClient / Seconds, NumClients, AllBytesPerClient / Seconds));
+	return true;
+}
+
+#endif
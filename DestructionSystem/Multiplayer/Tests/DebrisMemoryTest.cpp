@@ -0,0 +1,160 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "EngineUtils.h"
+#include "Engine/StaticMesh.h"
+#include "Components/StaticMeshComponent.h"
+#include "UObject/GCObjectScopeGuard.h"
+#include "TESTAutomationWorld.h"
+#include "TEST_DebrisPool.h"
+#include "TEST_Destructable.h"
+#include "TEST_FractureData.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace TESTDebrisMemoryTest
+{
+	const int32 NumDestructables = 2000;
+	const int32 NumPieces = 12;
+	const float DeltaTime = 1.f / 30.f;
+
+	struct FMemoryReport
+	{
+		int32 NumComponents = 0;
+		int32 NumRenderProxies = 0;
+		int64 Bytes = 0;
+	};
+
+	// Primitive components of all actors, debris pool and instances included
+	FMemoryReport MakeReport(UWorld* World)
+	{
+		FMemoryReport Report;
+		TArray<UPrimitiveComponent*> Components;
+		for (TActorIterator<AActor> It(World); It; ++It)
+		{
+			It->GetComponents(Components);
+			for (UPrimitiveComponent* Component : Components)
+			{
+				++Report.NumComponents;
+				Report.NumRenderProxies += Component->SceneProxy != nullptr ? 1 : 0;
+				Report.Bytes += Component->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+			}
+		}
+		return Report;
+	}
+
+	UTEST_FractureData* MakeFractureData(UStaticMesh* Mesh)
+	{
+		UTEST_FractureData* Data = NewObject<UTEST_FractureData>();
+		for (int32 Index = 0; Index < NumPieces; ++Index)
+		{
+			FTEST_DebrisPiece& Piece = Data->Pieces.AddDefaulted_GetRef();
+			Piece.Mesh = Mesh;
+			Piece.RelativeTransform = FTransform(FRotator::ZeroRotator, FVector((Index % 3) * 30.f, (Index / 3) * 30.f, 0.f), FVector(0.3f));
+		}
+		return Data;
+	}
+
+	ATEST_Destructable* SpawnDestructable(UWorld* World, UStaticMesh* Mesh, UTEST_FractureData* Data, const FVector& Location)
+	{
+		ATEST_Destructable* Destructable = World->SpawnActorDeferred<ATEST_Destructable>(ATEST_Destructable::StaticClass(), FTransform(Location));
+		Destructable->SolidMesh->SetStaticMesh(Mesh);
+		Destructable->FractureData = Data;
+		Destructable->FinishSpawning(FTransform(Location));
+		return Destructable;
+	}
+
+	// Part components destructables carried before debris pool, hidden and without collision
+	void AddHiddenParts(ATEST_Destructable* Destructable, const UTEST_FractureData* Data)
+	{
+		for (const FTEST_DebrisPiece& Piece : Data->Pieces)
+		{
+			UStaticMeshComponent* Part = NewObject<UStaticMeshComponent>(Destructable);
+			Part->SetStaticMesh(Piece.Mesh);
+			Part->SetRelativeTransform(Piece.RelativeTransform);
+			Part->SetHiddenInGame(true);
+			Part->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+			Part->SetupAttachment(Destructable->GetRootComponent());
+			Part->RegisterComponent();
+		}
+	}
+
+	void Break(ATEST_Destructable* Destructable)
+	{
+		FPointDamageEvent DamageEvent;
+		DamageEvent.Damage = Destructable->MaxHealth * 2.f;
+		DamageEvent.HitInfo.Location = Destructable->GetActorLocation();
+		Destructable->TakeDamage(DamageEvent.Damage, DamageEvent, nullptr, nullptr);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTESTDebrisMemoryReport, "TEST.Destruction.Debris.Memory", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FTESTDebrisMemoryReport::RunTest(const FString& Parameters)
+{
+	using namespace TESTDebrisMemoryTest;
+
+	UStaticMesh* Cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	if (!TestNotNull(TEXT("Engine cube mesh"), Cube))
+	{
+		return false;
+	}
+	UTEST_FractureData* Data = MakeFractureData(Cube);
+	// Survives garbage collection of first world
+	FGCObjectScopeGuard DataGuard(Data);
+
+	auto AddReport = [this](const TCHAR* Name, const FMemoryReport& Report, int32 NumActiveDebris, int32 NumDebrisComponents)
+	{
+		AddInfo(FString::Printf(TEXT("%s: %d primitive components, %d render proxies, %.1f KB, %d active debris, %d debris components"),
+			Name, Report.NumComponents, Report.NumRenderProxies, Report.Bytes / 1024.0, NumActiveDebris, NumDebrisComponents));
+	};
+
+	// Before: every destructable keeps its parts from BeginPlay
+	FMemoryReport HiddenPartsReport;
+	{
+		FTEST_AutomationWorld World;
+		for (int32 Index = 0; Index < NumDestructables; ++Index)
+		{
+			ATEST_Destructable* Destructable = SpawnDestructable(World.Get(), Cube, Data, FVector((Index % 50) * 300.f, (Index / 50) * 300.f, 0.f));
+			AddHiddenParts(Destructable, Data);
+		}
+		World.Tick(DeltaTime);
+		HiddenPartsReport = MakeReport(World.Get());
+		AddReport(TEXT("Hidden part components"), HiddenPartsReport, 0, 0);
+	}
+
+	// After: parts exist only while debris of broken destructables is shown
+	FTEST_AutomationWorld World;
+	UTEST_DebrisPool* Pool = World->GetSubsystem<UTEST_DebrisPool>();
+	TArray<ATEST_Destructable*> Destructables;
+	for (int32 Index = 0; Index < NumDestructables; ++Index)
+	{
+		Destructables.Add(SpawnDestructable(World.Get(), Cube, Data, FVector((Index % 50) * 300.f, (Index / 50) * 300.f, 0.f)));
+	}
+	World.Tick(DeltaTime);
+	const FMemoryReport IntactReport = MakeReport(World.Get());
+	AddReport(TEXT("Debris pool, intact"), IntactReport, Pool->GetNumActiveDebris(), Pool->GetNumDebrisComponents());
+	TestEqual(TEXT("Intact destructables hold no debris components"), Pool->GetNumDebrisComponents(), 0);
+	TestTrue(TEXT("Fewer components than with hidden parts"), IntactReport.NumComponents < HiddenPartsReport.NumComponents);
+	TestTrue(TEXT("Fewer render proxies than with hidden parts"), IntactReport.NumRenderProxies < HiddenPartsReport.NumRenderProxies);
+
+	// Fight breaks some of them
+	const int32 NumBroken = 50;
+	for (int32 Index = 0; Index < NumBroken; ++Index)
+	{
+		Break(Destructables[Index * (NumDestructables / NumBroken)]);
+	}
+	World.Tick(DeltaTime, 30);
+	AddReport(TEXT("Debris pool, after breaks"), MakeReport(World.Get()), Pool->GetNumActiveDebris(), Pool->GetNumDebrisComponents());
+	TestTrue(TEXT("Broken destructables show debris"), Pool->GetNumActiveDebris() > 0);
+
+	// Debris returns to pool, components stay for next breaks
+	World.Tick(0.25f, 60);
+	AddReport(TEXT("Debris pool, debris expired"), MakeReport(World.Get()), Pool->GetNumActiveDebris(), Pool->GetNumDebrisComponents());
+	TestEqual(TEXT("Expired debris returns to pool"), Pool->GetNumActiveDebris(), 0);
+	return true;
+}
+
+#endif
@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Engine/StaticMesh.h"
+#include "TESTAutomationWorld.h"
+#include "TEST_DebrisPool.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace TESTDebrisPoolTest
+{
+	// Pieces of engine cube placed side by side
+	bool MakePieces(int32 Count, TArray<FTEST_DebrisPiece>& OutPieces)
+	{
+		UStaticMesh* Cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+		if (Cube == nullptr)
+		{
+			return false;
+		}
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			FTEST_DebrisPiece& Piece = OutPieces.AddDefaulted_GetRef();
+			Piece.Mesh = Cube;
+			Piece.RelativeTransform = FTransform(FVector(Index * 100.f, 0.f, 0.f));
+		}
+		return true;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTESTDebrisPoolNetModeTest, "TEST.Destruction.Debris.NetMode", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTESTDebrisPoolNetModeTest::RunTest(const FString& Parameters)
+{
+	using namespace TESTDebrisPoolTest;
+
+	FTEST_AutomationWorld World;
+	UTEST_DebrisPool* Pool = World->GetSubsystem<UTEST_DebrisPool>();
+
+	// Only dedicated server skips debris, unless config asks for it
+	TestTrue(TEXT("Standalone spawns debris"), Pool->ShouldSpawnDebris(NM_Standalone));
+	TestTrue(TEXT("Listen server spawns debris"), Pool->ShouldSpawnDebris(NM_ListenServer));
+	TestTrue(TEXT("Client spawns debris"), Pool->ShouldSpawnDebris(NM_Client));
+	TestFalse(TEXT("Dedicated server skips debris"), Pool->ShouldSpawnDebris(NM_DedicatedServer));
+	Pool->bSimulateDebrisOnServer = true;
+	TestTrue(TEXT("Dedicated server spawns debris when configured"), Pool->ShouldSpawnDebris(NM_DedicatedServer));
+	Pool->bSimulateDebrisOnServer = false;
+
+	// Debris follows decision for net mode of this world and returns after life time
+	TArray<FTEST_DebrisPiece> Pieces;
+	if (!TestTrue(TEXT("Engine cube mesh"), MakePieces(3, Pieces)))
+	{
+		return false;
+	}
+	const bool bExpectDebris = Pool->ShouldSpawnDebris(World->GetNetMode());
+	Pool->SpawnDebris(Pieces, FTransform::Identity, FVector(0.f, 0.f, 500.f), 1.f, 7);
+	TestEqual(TEXT("Active debris after break"), Pool->GetNumActiveDebris(), bExpectDebris ? Pieces.Num() : 0);
+	World.Tick(0.25f, 8);
+	TestEqual(TEXT("Expired debris returns to pool"), Pool->GetNumActiveDebris(), 0);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTESTDebrisPoolDedicatedServerTest, "TEST.Destruction.Debris.DedicatedServer", EAutomationTestFlags::ServerContext | EAutomationTestFlags::EngineFilter)
+
+bool FTESTDebrisPoolDedicatedServerTest::RunTest(const FString& Parameters)
+{
+	using namespace TESTDebrisPoolTest;
+
+	// Listed only when automation runs in a -server process
+	FTEST_AutomationWorld World;
+	if (!TestEqual(TEXT("World runs as dedicated server"), static_cast<int32>(World->GetNetMode()), static_cast<int32>(NM_DedicatedServer)))
+	{
+		return false;
+	}
+
+	TArray<FTEST_DebrisPiece> Pieces;
+	if (!TestTrue(TEXT("Engine cube mesh"), MakePieces(3, Pieces)))
+	{
+		return false;
+	}
+	UTEST_DebrisPool* Pool = World->GetSubsystem<UTEST_DebrisPool>();
+	Pool->SpawnDebris(Pieces, FTransform::Identity, FVector(0.f, 0.f, 500.f), 10.f, 7);
+	TestEqual(TEXT("Dedicated server keeps no debris"), Pool->GetNumActiveDebris(), 0);
+	return true;
+}
+
+#endif
@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "TESTAutomationWorld.h"
+#include "TESTProjectile.h"
+#include "TEST_Destructable.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace TESTDestructableDamageTest
+{
+	// Hit of projectile on destructable, like OnHit of projectile actor
+	void Hit(ATEST_Destructable* Destructable, AActor* Causer, float Damage)
+	{
+		FPointDamageEvent DamageEvent;
+		DamageEvent.Damage = Damage;
+		DamageEvent.HitInfo.Location = Destructable->GetActorLocation();
+		Destructable->TakeDamage(Damage, DamageEvent, nullptr, Causer);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTESTDestructableRapidHitTest, "TEST.Destruction.RapidHits", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTESTDestructableRapidHitTest::RunTest(const FString& Parameters)
+{
+	using namespace TESTDestructableDamageTest;
+
+	FTEST_AutomationWorld World;
+	ATEST_Destructable* Destructable = World->SpawnActor<ATEST_Destructable>(FVector::ZeroVector, FRotator::ZeroRotator);
+	ATESTProjectile* Projectile = World->SpawnActor<ATESTProjectile>(FVector(0.f, 0.f, 10000.f), FRotator::ZeroRotator);
+	ATESTProjectile* OtherProjectile = World->SpawnActor<ATESTProjectile>(FVector(0.f, 0.f, 20000.f), FRotator::ZeroRotator);
+	if (!TestNotNull(TEXT("Destructable"), Destructable) || !TestNotNull(TEXT("Projectile"), Projectile) || !TestNotNull(TEXT("Other projectile"), OtherProjectile))
+	{
+		return false;
+	}
+	const float MaxHealth = Destructable->MaxHealth;
+	const float Damage = MaxHealth * 0.6f;
+
+	// Projectile reporting many hits in one frame damages once, one transition to damaged
+	for (int32 HitIndex = 0; HitIndex < 10; ++HitIndex)
+	{
+		Hit(Destructable, Projectile, Damage);
+	}
+	TestTrue(TEXT("State changes only on next tick"), Destructable->GetState() == ETESTDestructableState::Solid);
+	World.Tick(0.016f);
+	TestTrue(TEXT("Repeated hits make one transition"), Destructable->GetState() == ETESTDestructableState::Damaged);
+	TestEqual(TEXT("Repeated hits are coalesced"), Destructable->GetHealth(), MaxHealth - Damage);
+
+	// Other causer in the same frame is not coalesced
+	Hit(Destructable, Projectile, 0.1f);
+	Hit(Destructable, OtherProjectile, 0.1f);
+	World.Tick(0.016f);
+	TestEqual(TEXT("Different causers both damage"), Destructable->GetHealth(), MaxHealth - Damage - 0.2f, 0.001f);
+
+	// Same projectile in next frame damages again and breaks object once
+	for (int32 Frame = 0; Frame < 2; ++Frame)
+	{
+		Hit(Destructable, Projectile, Damage);
+		Hit(Destructable, Projectile, Damage);
+		World.Tick(0.016f);
+	}
+	TestTrue(TEXT("Hits in next frames break object"), Destructable->GetState() == ETESTDestructableState::Broken);
+	TestEqual(TEXT("Broken object keeps zero health"), Destructable->GetHealth(), 0.f);
+	return true;
+}
+
+#endif
@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Engine/StaticMesh.h"
+#include "Components/HierarchicalInstancedStaticMeshComponent.h"
+#include "TESTAutomationWorld.h"
+#include "TEST_Destructable.h"
+#include "TEST_DestructableInstances.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace TESTDestructableInstancesTest
+{
+	// Destructable with engine cube, mesh is set before components are registered
+	ATEST_Destructable* SpawnDestructable(UWorld* World, UStaticMesh* Mesh, const FVector& Location, bool bInstanced = true)
+	{
+		ATEST_Destructable* Destructable = World->SpawnActorDeferred<ATEST_Destructable>(ATEST_Destructable::StaticClass(), FTransform(Location));
+		Destructable->SolidMesh->SetStaticMesh(Mesh);
+		Destructable->bUseInstancedRendering = bInstanced;
+		Destructable->FinishSpawning(FTransform(Location));
+		return Destructable;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTESTDestructableInstancesTest, "TEST.Destruction.Instances", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTESTDestructableInstancesTest::RunTest(const FString& Parameters)
+{
+	using namespace TESTDestructableInstancesTest;
+
+	UStaticMesh* Cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	if (!TestNotNull(TEXT("Engine cube mesh"), Cube))
+	{
+		return false;
+	}
+
+	FTEST_AutomationWorld World;
+	UTEST_DestructableInstances* Instances = World->GetSubsystem<UTEST_DestructableInstances>();
+
+	// Destructables with the same mesh share one instanced component
+	TArray<ATEST_Destructable*> Destructables;
+	for (int32 Index = 0; Index < 3; ++Index)
+	{
+		Destructables.Add(SpawnDestructable(World.Get(), Cube, FVector(Index * 200.f, 0.f, 0.f)));
+	}
+	UHierarchicalInstancedStaticMeshComponent* Component = Destructables[0]->GetInstanceComponent();
+	if (!TestNotNull(TEXT("Intact destructable is drawn as instance"), Component))
+	{
+		return false;
+	}
+	TestEqual(TEXT("Instances in shared component"), Component->GetInstanceCount(), 3);
+	for (ATEST_Destructable* Destructable : Destructables)
+	{
+		TestTrue(TEXT("Destructables share component"), Destructable->GetInstanceComponent() == Component);
+		TestTrue(TEXT("Instance owner is destructable"), Instances->GetInstanceOwner(Component, Destructable->GetInstanceIndex()) == Destructable);
+		TestFalse(TEXT("Own mesh is hidden"), Destructable->SolidMesh->IsVisible());
+		TestTrue(TEXT("Own mesh keeps collision"), Destructable->SolidMesh->IsCollisionEnabled());
+	}
+
+	// Opted out destructable draws own mesh
+	ATEST_Destructable* NotInstanced = SpawnDestructable(World.Get(), Cube, FVector(0.f, 500.f, 0.f), false);
+	TestNull(TEXT("Opted out destructable has no instance"), NotInstanced->GetInstanceComponent());
+	TestTrue(TEXT("Opted out destructable shows own mesh"), NotInstanced->SolidMesh->IsVisible());
+
+	// Damage stage shows own mesh and frees instance
+	ATEST_Destructable* Damaged = Destructables[1];
+	const int32 DamagedIndex = Damaged->GetInstanceIndex();
+	Damaged->TakeDamage(Damaged->MaxHealth * 0.75f, FDamageEvent(), nullptr, nullptr);
+	World.Tick(0.1f);
+	TestNull(TEXT("Damaged destructable has no instance"), Damaged->GetInstanceComponent());
+	TestTrue(TEXT("Damaged destructable shows own mesh"), Damaged->SolidMesh->IsVisible());
+	TestNull(TEXT("Freed instance has no owner"), Instances->GetInstanceOwner(Component, DamagedIndex));
+
+	// Freed instance is reused, indices of other instances do not change
+	const int32 LastIndex = Destructables[2]->GetInstanceIndex();
+	ATEST_Destructable* Reusing = SpawnDestructable(World.Get(), Cube, FVector(0.f, -500.f, 0.f));
+	TestEqual(TEXT("Freed instance index is reused"), Reusing->GetInstanceIndex(), DamagedIndex);
+	TestEqual(TEXT("Instance count does not grow"), Component->GetInstanceCount(), 3);
+	TestEqual(TEXT("Other instance keeps index"), Destructables[2]->GetInstanceIndex(), LastIndex);
+
+	// Destroyed destructable frees its instance too
+	const int32 DestroyedIndex = Destructables[0]->GetInstanceIndex();
+	Destructables[0]->Destroy();
+	TestNull(TEXT("Destroyed destructable frees instance"), Instances->GetInstanceOwner(Component, DestroyedIndex));
+	return true;
+}
+
+#endif
@@ -0,0 +1,125 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "Engine/StaticMesh.h"
+#include "TESTAutomationWorld.h"
+#include "TESTNetTestSession.h"
+#include "TEST_Destructable.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace TESTDestructableReplicationTest
+{
+	const float DeltaTime = 1.f / 30.f;
+	const float MapExtent = 50000.f;
+
+	ATEST_Destructable* SpawnDestructable(UWorld* World, UStaticMesh* Mesh, const FVector& Location)
+	{
+		ATEST_Destructable* Destructable = World->SpawnActorDeferred<ATEST_Destructable>(ATEST_Destructable::StaticClass(), FTransform(Location));
+		Destructable->SolidMesh->SetStaticMesh(Mesh);
+		Destructable->FinishSpawning(FTransform(Location));
+		return Destructable;
+	}
+
+	// Replication settings every actor had before destructables got own policy
+	void UseDefaultReplication(AActor* Actor)
+	{
+		const AActor* Defaults = GetDefault<AActor>();
+		Actor->SetNetDormancy(DORM_Awake);
+		Actor->NetUpdateFrequency = Defaults->NetUpdateFrequency;
+		Actor->MinNetUpdateFrequency = Defaults->MinNetUpdateFrequency;
+		Actor->NetCullDistanceSquared = Defaults->NetCullDistanceSquared;
+	}
+
+	void Hit(ATEST_Destructable* Destructable, float Damage)
+	{
+		FPointDamageEvent DamageEvent;
+		DamageEvent.Damage = Damage;
+		DamageEvent.HitInfo.Location = Destructable->GetActorLocation();
+		Destructable->TakeDamage(Damage, DamageEvent, nullptr, nullptr);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTESTDestructableReplicationBenchmark, "TEST.Destruction.Replication.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FTESTDestructableReplicationBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace TESTDestructableReplicationTest;
+
+	const int32 NumDestructables = 2000;
+	const int32 NumClients = 32;
+	const int32 WarmupFrames = 30;
+	const int32 NumFrames = 300;
+
+	UStaticMesh* Cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	if (!TestNotNull(TEXT("Engine cube mesh"), Cube))
+	{
+		return false;
+	}
+
+	for (const bool bDormant : { false, true })
+	{
+		FTEST_AutomationWorld World;
+		FTEST_NetTestSession Session(World.Get(), NumClients);
+		if (!TestTrue(TEXT("Server listens with simulated clients"), Session.IsListening()))
+		{
+			return false;
+		}
+
+		FRandomStream Random(19);
+		TArray<ATEST_Destructable*> Destructables;
+		for (int32 Index = 0; Index < NumDestructables; ++Index)
+		{
+			const FVector Location(Random.FRandRange(-MapExtent, MapExtent), Random.FRandRange(-MapExtent, MapExtent), 0.f);
+			ATEST_Destructable* Destructable = SpawnDestructable(World.Get(), Cube, Location);
+			if (bDormant)
+			{
+				// Initial dormancy works only for actors placed in level
+				Destructable->SetNetDormancy(DORM_DormantAll);
+			}
+			else
+			{
+				UseDefaultReplication(Destructable);
+			}
+			Destructables.Add(Destructable);
+		}
+		for (int32 Client = 0; Client < NumClients; ++Client)
+		{
+			Session.SetViewLocation(Client, FVector(Random.FRandRange(-MapExtent, MapExtent), Random.FRandRange(-MapExtent, MapExtent), 0.f));
+		}
+
+		// Initial replication is same for both, only idle map is measured
+		for (int32 Frame = 0; Frame < WarmupFrames; ++Frame)
+		{
+			World.Tick(DeltaTime);
+			Session.Tick(DeltaTime);
+		}
+
+		// Some destructables are hit now and then, each hit changes state
+		const int64 StartBytes = Session.GetOutBytes();
+		double NetTime = 0.0;
+		double WorstNetTime = 0.0;
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			if (Frame % 10 == 0)
+			{
+				ATEST_Destructable* Destructable = Destructables[Random.RandHelper(NumDestructables)];
+				Hit(Destructable, Destructable->MaxHealth * 0.3f);
+			}
+			World.Tick(DeltaTime);
+			const double FrameNetTime = Session.Tick(DeltaTime);
+			NetTime += FrameNetTime;
+			WorstNetTime = FMath::Max(WorstNetTime, FrameNetTime);
+		}
+		const double BytesPerSecond = (Session.GetOutBytes() - StartBytes) / (NumFrames * DeltaTime);
+
+		AddInfo(FString::Printf(TEXT("%d destructables, %d clients, %s: server net tick %.3f ms per frame (worst %.3f ms), %.0f bytes/s to all clients, %.0f bytes/s per client"),
+			NumDestructables, NumClients, bDormant ? TEXT("dormant policy") : TEXT("default replication"),
+			NetTime * 1000.0 / NumFrames, WorstNetTime * 1000.0, BytesPerSecond, BytesPerSecond / NumClients));
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,92 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Components/StaticMeshComponent.h"
+#include "TESTAutomationWorld.h"
+#include "TEST_Destructable.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace TESTDestructableSpawnTest
+{
+	FTransform GetSpawnTransform(int32 Index)
+	{
+		return FTransform(FVector((Index % 100) * 300.f, (Index / 100) * 300.f, 0.f));
+	}
+
+	// Deferred spawn lets construction be timed apart from
+	// FinishSpawning, which runs PostInitializeComponents and BeginPlay
+	template<typename ActorType, typename SetupFuncType>
+	void SpawnTimed(UWorld* World, int32 Count, SetupFuncType Setup, double& OutConstructTime, double& OutFinishTime)
+	{
+		OutConstructTime = 0.0;
+		OutFinishTime = 0.0;
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			const FTransform Transform = GetSpawnTransform(Index);
+			double StartTime = FPlatformTime::Seconds();
+			ActorType* Actor = World->SpawnActorDeferred<ActorType>(ActorType::StaticClass(), Transform);
+			OutConstructTime += FPlatformTime::Seconds() - StartTime;
+			Setup(Actor);
+			StartTime = FPlatformTime::Seconds();
+			Actor->FinishSpawning(Transform);
+			OutFinishTime += FPlatformTime::Seconds() - StartTime;
+		}
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTESTDestructableSpawnBenchmark, "TEST.Destruction.Spawn.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FTESTDestructableSpawnBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace TESTDestructableSpawnTest;
+
+	const int32 NumActors = 10000;
+	UStaticMesh* Cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+	if (!TestNotNull(TEXT("Engine cube mesh"), Cube))
+	{
+		return false;
+	}
+
+	auto AddTimes = [this, NumActors](const TCHAR* Name, double ConstructTime, double FinishTime)
+	{
+		AddInfo(FString::Printf(TEXT("%d %s: construction %.3f us, PostInitializeComponents + BeginPlay %.3f us per actor, %.1f ms total"),
+			NumActors, Name, ConstructTime * 1000000.0 / NumActors, FinishTime * 1000000.0 / NumActors, (ConstructTime + FinishTime) * 1000.0));
+	};
+
+	// Engine cost of mesh actor, without anything destructable adds
+	{
+		FTEST_AutomationWorld World;
+		double ConstructTime = 0.0;
+		double FinishTime = 0.0;
+		SpawnTimed<AStaticMeshActor>(World.Get(), NumActors, [Cube](AStaticMeshActor* Actor)
+		{
+			Actor->GetStaticMeshComponent()->SetStaticMesh(Cube);
+		}, ConstructTime, FinishTime);
+		AddTimes(TEXT("static mesh actors"), ConstructTime, FinishTime);
+	}
+
+	for (const bool bInstanced : { false, true })
+	{
+		FTEST_AutomationWorld World;
+		double ConstructTime = 0.0;
+		double FinishTime = 0.0;
+		int32 NumSpawned = 0;
+		SpawnTimed<ATEST_Destructable>(World.Get(), NumActors, [Cube, bInstanced, &NumSpawned](ATEST_Destructable* Destructable)
+		{
+			Destructable->SolidMesh->SetStaticMesh(Cube);
+			Destructable->bUseInstancedRendering = bInstanced;
+			++NumSpawned;
+		}, ConstructTime, FinishTime);
+		TestEqual(TEXT("Destructables spawned"), NumSpawned, NumActors);
+		AddTimes(bInstanced ? TEXT("instanced destructables") : TEXT("destructables"), ConstructTime, FinishTime);
+	}
+	return true;
+}
+
+#endif
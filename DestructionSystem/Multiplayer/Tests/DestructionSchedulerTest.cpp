@@ -0,0 +1,174 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "HAL/IConsoleManager.h"
+#include "GameFramework/PlayerController.h"
+#include "TESTAutomationWorld.h"
+#include "TEST_Destructable.h"
+#include "TEST_DestructionScheduler.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace TESTDestructionSchedulerTest
+{
+	// Sets break budget for the scope of test
+	struct FScopedBreakBudget
+	{
+		explicit FScopedBreakBudget(float BudgetMs)
+		{
+			CVar = IConsoleManager::Get().FindConsoleVariable(TEXT("TEST.Destruction.BreakBudgetMs"));
+			PreviousBudgetMs = CVar->GetFloat();
+			CVar->Set(BudgetMs, ECVF_SetByCode);
+		}
+
+		~FScopedBreakBudget()
+		{
+			CVar->Set(PreviousBudgetMs, ECVF_SetByCode);
+		}
+
+		IConsoleVariable* CVar;
+		float PreviousBudgetMs;
+	};
+
+	bool IsBroken(const ATEST_Destructable* Destructable)
+	{
+		return Destructable->SolidMesh == nullptr || Destructable->SolidMesh->IsBeingDestroyed();
+	}
+
+	// Destructables on a square grid around origin, player views origin
+	void SpawnGrid(UWorld* World, int32 Count, TArray<ATEST_Destructable*>& OutDestructables)
+	{
+		World->SpawnActor<APlayerController>(FVector::ZeroVector, FRotator::ZeroRotator);
+		const int32 Side = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(Count)));
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			const FVector Location((Index % Side - Side / 2) * 300.f, (Index / Side - Side / 2) * 300.f, 0.f);
+			OutDestructables.Add(World->SpawnActor<ATEST_Destructable>(Location, FRotator::ZeroRotator));
+		}
+	}
+
+	// True if no pending break is closer to view than a done one
+	bool IsClosestFirst(const TArray<ATEST_Destructable*>& Destructables)
+	{
+		float FarthestBroken = 0.f;
+		float ClosestPending = MAX_flt;
+		for (const ATEST_Destructable* Destructable : Destructables)
+		{
+			const float DistanceSquared = Destructable->GetActorLocation().SizeSquared();
+			if (IsBroken(Destructable))
+			{
+				FarthestBroken = FMath::Max(FarthestBroken, DistanceSquared);
+			}
+			else
+			{
+				ClosestPending = FMath::Min(ClosestPending, DistanceSquared);
+			}
+		}
+		return FarthestBroken <= ClosestPending;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTESTDestructionSchedulerTest, "TEST.Destruction.Scheduler", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTESTDestructionSchedulerTest::RunTest(const FString& Parameters)
+{
+	using namespace TESTDestructionSchedulerTest;
+
+	FTEST_AutomationWorld World;
+	UTEST_DestructionScheduler* Scheduler = World->GetSubsystem<UTEST_DestructionScheduler>();
+	TArray<ATEST_Destructable*> Destructables;
+	SpawnGrid(World.Get(), 9, Destructables);
+
+	// Requests in any order, tiny budget allows one break per frame
+	{
+		FScopedBreakBudget Budget(0.0001f);
+		for (int32 Index = Destructables.Num() - 1; Index >= 0; --Index)
+		{
+			Scheduler->RequestBreak(Destructables[Index]);
+		}
+		TestEqual(TEXT("Breaks wait for scheduler tick"), Scheduler->GetNumPendingBreaks(), 9);
+		World.Tick(0.016f);
+		TestTrue(TEXT("At least one break per frame"), Scheduler->GetNumPendingBreaks() < 9);
+		TestTrue(TEXT("Budget spreads breaks over frames"), Scheduler->GetNumPendingBreaks() > 0);
+		TestTrue(TEXT("Closest break is done first"), IsClosestFirst(Destructables));
+	}
+
+	// Zero budget breaks everything at once
+	{
+		FScopedBreakBudget Budget(0.f);
+		World.Tick(0.016f);
+		TestEqual(TEXT("Zero budget leaves nothing pending"), Scheduler->GetNumPendingBreaks(), 0);
+	}
+	for (const ATEST_Destructable* Destructable : Destructables)
+	{
+		TestTrue(TEXT("Every requested destructable is broken"), IsBroken(Destructable));
+	}
+
+	// Destroyed destructable is skipped
+	ATEST_Destructable* Destroyed = World->SpawnActor<ATEST_Destructable>(FVector::ZeroVector, FRotator::ZeroRotator);
+	Scheduler->RequestBreak(Destroyed);
+	Destroyed->Destroy();
+	CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+	World.Tick(0.016f);
+	TestEqual(TEXT("Stale break is dropped"), Scheduler->GetNumPendingBreaks(), 0);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTESTDestructionSchedulerStressTest, "TEST.Destruction.Scheduler.Stress", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTESTDestructionSchedulerStressTest::RunTest(const FString& Parameters)
+{
+	using namespace TESTDestructionSchedulerTest;
+
+	const int32 Count = 500;
+	const float BudgetMs = 0.5f;
+
+	FTEST_AutomationWorld World;
+	UTEST_DestructionScheduler* Scheduler = World->GetSubsystem<UTEST_DestructionScheduler>();
+	TArray<ATEST_Destructable*> Destructables;
+	SpawnGrid(World.Get(), Count, Destructables);
+
+	// Chain reaction breaking everything in one frame
+	FScopedBreakBudget Budget(BudgetMs);
+	const double RequestStart = FPlatformTime::Seconds();
+	for (ATEST_Destructable* Destructable : Destructables)
+	{
+		Scheduler->RequestBreak(Destructable);
+	}
+	const double RequestMs = (FPlatformTime::Seconds() - RequestStart) * 1000.0;
+
+	int32 Frames = 0;
+	double MaxFrameMs = 0.0;
+	bool bClosestFirst = true;
+	while (Scheduler->GetNumPendingBreaks() > 0 && Frames < Count)
+	{
+		const int32 PendingBefore = Scheduler->GetNumPendingBreaks();
+		const double FrameStart = FPlatformTime::Seconds();
+		World.Tick(0.016f);
+		MaxFrameMs = FMath::Max(MaxFrameMs, (FPlatformTime::Seconds() - FrameStart) * 1000.0);
+		++Frames;
+		if (Scheduler->GetNumPendingBreaks() >= PendingBefore)
+		{
+			AddError(FString::Printf(TEXT("Frame %d did no break"), Frames));
+			break;
+		}
+		bClosestFirst &= IsClosestFirst(Destructables);
+	}
+
+	TestEqual(TEXT("All breaks are done"), Scheduler->GetNumPendingBreaks(), 0);
+	TestTrue(TEXT("Breaks are done closest first in every frame"), bClosestFirst);
+	for (const ATEST_Destructable* Destructable : Destructables)
+	{
+		if (!IsBroken(Destructable))
+		{
+			AddError(TEXT("Destructable was not broken"));
+			break;
+		}
+	}
+	AddInfo(FString::Printf(TEXT("%d breaks: requests %.3f ms, %d frames, max frame %.3f ms with budget %.2f ms"), Count, RequestMs, Frames, MaxFrameMs, BudgetMs));
+	return true;
+}
+
+#endif
@@ -0,0 +1,164 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "Components/CapsuleComponent.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+#include "TESTAutomationWorld.h"
+#include "TESTProjectile.h"
+#include "TEST_LagCompensation.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace TESTLagCompensationTest
+{
+	const float DeltaTime = 0.02f;
+
+	bool IsHit(const UTEST_LagCompensation* LagCompensation, float Y, float Time, const AActor* Expected)
+	{
+		FHitResult Hit;
+		return LagCompensation->RewindAndTest(FVector(0.f, Y, 0.f), FVector(2000.f, Y, 0.f), Time, nullptr, Hit) && Hit.GetActor() == Expected;
+	}
+
+	// Character standing still in empty world, without falling
+	ACharacter* SpawnCharacter(UWorld* World, const FVector& Location)
+	{
+		ACharacter* Character = World->SpawnActor<ACharacter>(Location, FRotator::ZeroRotator);
+		if (Character != nullptr)
+		{
+			Character->GetCharacterMovement()->DisableMovement();
+		}
+		return Character;
+	}
+
+	ATESTProjectile* SpawnProjectile(UWorld* World, const FVector& Location, APawn* Shooter)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.Instigator = Shooter;
+		return World->SpawnActor<ATESTProjectile>(Location, FRotator::ZeroRotator, SpawnParams);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTESTLagCompensationTest, "TEST.Projectile.LagCompensation", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTESTLagCompensationTest::RunTest(const FString& Parameters)
+{
+	using namespace TESTLagCompensationTest;
+
+	FTEST_AutomationWorld World;
+	UTEST_LagCompensation* LagCompensation = World->GetSubsystem<UTEST_LagCompensation>();
+	LagCompensation->SampleRate = 1.f / DeltaTime;
+	ACharacter* Shooter = SpawnCharacter(World.Get(), FVector(0.f, -2000.f, 0.f));
+	ACharacter* Target = SpawnCharacter(World.Get(), FVector(1000.f, 0.f, 0.f));
+	if (!TestNotNull(TEXT("Shooter"), Shooter) || !TestNotNull(TEXT("Target"), Target))
+	{
+		return false;
+	}
+	LagCompensation->Register(Target);
+
+	// Target moves away after time seen by shooting client
+	World.Tick(DeltaTime, 10);
+	const float ClientTime = LagCompensation->GetServerTime();
+	Target->SetActorLocation(FVector(1000.f, 500.f, 0.f));
+	World.Tick(DeltaTime, 5);
+	const float ServerTime = LagCompensation->GetServerTime();
+	const float CatchUpTime = ServerTime - ClientTime;
+
+	TestTrue(TEXT("Rewound shot hits past location"), IsHit(LagCompensation, 0.f, ClientTime, Target));
+	TestFalse(TEXT("Rewound shot misses present location"), IsHit(LagCompensation, 500.f, ClientTime, Target));
+	TestTrue(TEXT("Present shot hits present location"), IsHit(LagCompensation, 500.f, ServerTime, Target));
+	TestFalse(TEXT("Present shot misses past location"), IsHit(LagCompensation, 0.f, ServerTime, Target));
+
+	// Projectile sphere hits capsule its center passes by
+	const float CapsuleRadius = Target->GetCapsuleComponent()->GetScaledCapsuleRadius();
+	const float ShotRadius = 10.f;
+	const float Y = CapsuleRadius + ShotRadius * 0.5f;
+	FHitResult RadiusHit;
+	TestFalse(TEXT("Line beside capsule misses"), IsHit(LagCompensation, Y, ClientTime, Target));
+	TestTrue(TEXT("Sphere beside capsule hits"), LagCompensation->RewindAndTest(FVector(0.f, Y, 0.f), FVector(2000.f, Y, 0.f), ClientTime, nullptr, RadiusHit, ShotRadius) && RadiusHit.GetActor() == Target);
+	TestFalse(TEXT("Sphere further from capsule misses"), LagCompensation->RewindAndTest(FVector(0.f, Y + ShotRadius, 0.f), FVector(2000.f, Y + ShotRadius, 0.f), ClientTime, nullptr, RadiusHit, ShotRadius));
+
+	// Catch-up sweep takes characters only from history, not from physics scene
+	const USphereComponent* Collision = GetDefault<ATESTProjectile>()->GetCollisionComp();
+	FHitResult Hit;
+	TestFalse(TEXT("Catch-up sweep ignores present capsule"), LagCompensation->SweepRewound(FVector(0.f, 500.f, 0.f), FVector(2000.f, 500.f, 0.f), Collision, ClientTime, Shooter, Hit));
+	TestTrue(TEXT("Catch-up sweep hits rewound capsule"), LagCompensation->SweepRewound(FVector(0.f, 0.f, 0.f), FVector(2000.f, 0.f, 0.f), Collision, ClientTime, Shooter, Hit) && Hit.GetActor() == Target);
+
+	// Projectile actor catches up the same way, starting close enough to reach target
+	ATESTProjectile* Missing = SpawnProjectile(World.Get(), FVector(0.f, 500.f, 0.f), Shooter);
+	if (!TestNotNull(TEXT("Projectile"), Missing))
+	{
+		return false;
+	}
+	const float Speed = Missing->GetProjectileMovement()->Velocity.Size();
+	const float StartX = 1000.f - Speed * CatchUpTime * 0.5f;
+	Missing->SetActorLocation(FVector(StartX, 500.f, 0.f));
+	Missing->CatchUp(CatchUpTime);
+	TestFalse(TEXT("Projectile passing present capsule flies on"), Missing->IsPendingKillPending());
+	TestEqual(TEXT("Projectile moved by latency"), Missing->GetActorLocation().X, StartX + Speed * CatchUpTime, 1.f);
+
+	ATESTProjectile* Hitting = SpawnProjectile(World.Get(), FVector(StartX, 0.f, 0.f), Shooter);
+	Hitting->CatchUp(CatchUpTime);
+	TestTrue(TEXT("Projectile hitting rewound capsule resolves impact"), Hitting->IsPendingKillPending());
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTESTLagCompensationBenchmark, "TEST.Projectile.LagCompensation.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FTESTLagCompensationBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace TESTLagCompensationTest;
+
+	const int32 NumCharacters = 64;
+	const int32 NumShots = 10000;
+	FRandomStream Random(5);
+
+	FTEST_AutomationWorld World;
+	UTEST_LagCompensation* LagCompensation = World->GetSubsystem<UTEST_LagCompensation>();
+	LagCompensation->SampleRate = 1.f / DeltaTime;
+	TArray<ACharacter*> Characters;
+	for (int32 Index = 0; Index < NumCharacters; ++Index)
+	{
+		ACharacter* Character = SpawnCharacter(World.Get(), FVector(Random.FRandRange(-2000.f, 2000.f), Random.FRandRange(-2000.f, 2000.f), 0.f));
+		LagCompensation->Register(Character);
+		Characters.Add(Character);
+	}
+
+	// Fill whole history with moving characters
+	double RecordTime = 0.0;
+	for (int32 Frame = 0; Frame < FTEST_HitboxHistory::HistorySize; ++Frame)
+	{
+		for (ACharacter* Character : Characters)
+		{
+			Character->AddActorWorldOffset(FVector(Random.FRandRange(-10.f, 10.f), Random.FRandRange(-10.f, 10.f), 0.f));
+		}
+		const double StartTime = FPlatformTime::Seconds();
+		World.Tick(DeltaTime);
+		RecordTime += FPlatformTime::Seconds() - StartTime;
+	}
+
+	// Shots across the area at random times inside accepted rewind
+	const float ServerTime = LagCompensation->GetServerTime();
+	int32 NumHits = 0;
+	FHitResult Hit;
+	const double StartTime = FPlatformTime::Seconds();
+	for (int32 Shot = 0; Shot < NumShots; ++Shot)
+	{
+		const FVector Start(-2500.f, Random.FRandRange(-2000.f, 2000.f), 0.f);
+		const FVector End(2500.f, Random.FRandRange(-2000.f, 2000.f), 0.f);
+		const float Time = ServerTime - Random.FRandRange(0.f, LagCompensation->MaxRewindTime);
+		NumHits += LagCompensation->RewindAndTest(Start, End, Time, nullptr, Hit) ? 1 : 0;
+	}
+	const double RewindTime = FPlatformTime::Seconds() - StartTime;
+
+	TestTrue(TEXT("Shots hit rewound characters"), NumHits > 0);
+	AddInfo(FString::Printf(TEXT("%d characters: %.3f us per frame with recording, %.3f us per rewound shot (%d of %d hit)"),
+		NumCharacters, RecordTime * 1000000.0 / FTEST_HitboxHistory::HistorySize, RewindTime * 1000000.0 / NumShots, NumHits, NumShots));
+	return true;
+}
+
+#endif
@@ -0,0 +1,170 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "EngineUtils.h"
+#include "TESTAutomationWorld.h"
+#include "TESTProjectile.h"
+#include "Engine/CollisionProfile.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/StaticMeshActor.h"
+#include "Components/StaticMeshComponent.h"
+#include "TEST_ProjectileBatch.h"
+#include "TEST_ProjectileEvents.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTESTProjectileBatchTest, "TEST.Projectile.Batch", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTESTProjectileBatchTest::RunTest(const FString& Parameters)
+{
+	FTEST_AutomationWorld World;
+	UTEST_ProjectileBatch* Batch = World->GetSubsystem<UTEST_ProjectileBatch>();
+	const TSubclassOf<ATESTProjectile> ProjectileClass = ATESTProjectile::StaticClass();
+
+	Batch->FireProjectile(ProjectileClass, FVector::ZeroVector, FRotator::ZeroRotator, nullptr);
+	TestEqual(TEXT("Projectiles in flight"), Batch->GetNumProjectiles(), 1);
+
+	// Impact events do not depend on instigator, one events actor per world
+	int32 NumEvents = 0;
+	for (TActorIterator<ATEST_ProjectileEvents> It(World.Get()); It; ++It)
+	{
+		++NumEvents;
+	}
+	TestEqual(TEXT("Events actors after first shot"), NumEvents, 1);
+
+	// Projectile disappears after its life span without hitting anything
+	const float LifeSpan = ProjectileClass->GetDefaultObject<ATESTProjectile>()->InitialLifeSpan;
+	World.Tick(0.1f, FMath::CeilToInt(LifeSpan / 0.1f) + 1);
+	TestEqual(TEXT("Projectiles after life span"), Batch->GetNumProjectiles(), 0);
+	return true;
+}
+
+namespace TESTProjectileBatchTest
+{
+	const float WallDistance = 2000.f;
+
+	// Wall of engine cube across path of all shots
+	bool SpawnWall(UWorld* World)
+	{
+		UStaticMesh* Cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+		if (Cube == nullptr)
+		{
+			return false;
+		}
+		AStaticMeshActor* Wall = World->SpawnActor<AStaticMeshActor>(FVector(WallDistance, 0.f, 0.f), FRotator::ZeroRotator);
+		UStaticMeshComponent* Mesh = Wall->GetStaticMeshComponent();
+		Mesh->SetMobility(EComponentMobility::Movable);
+		Mesh->SetStaticMesh(Cube);
+		Mesh->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+		Wall->SetActorScale3D(FVector(1.f, 40.f, 40.f));
+		return true;
+	}
+
+	// Shot from plane at origin towards wall
+	void MakeShot(FRandomStream& Random, FVector& OutLocation, FRotator& OutRotation)
+	{
+		OutLocation = FVector(0.f, Random.FRandRange(-1000.f, 1000.f), Random.FRandRange(-1000.f, 1000.f));
+		OutRotation = FRotator(Random.FRandRange(-5.f, 5.f), Random.FRandRange(-5.f, 5.f), 0.f);
+	}
+
+	int32 CountFlyingActors(UWorld* World)
+	{
+		int32 Count = 0;
+		for (TActorIterator<ATESTProjectile> It(World); It; ++It)
+		{
+			Count += It->IsPendingKill() ? 0 : 1;
+		}
+		return Count;
+	}
+}
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FTESTProjectileBatchBenchmark, "TEST.Projectile.Batch.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+void FTESTProjectileBatchBenchmark::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	for (const int32 NumProjectiles : { 1000, 10000 })
+	{
+		OutBeautifiedNames.Add(FString::Printf(TEXT("%d"), NumProjectiles));
+		OutTestCommands.Add(FString::FromInt(NumProjectiles));
+	}
+}
+
+bool FTESTProjectileBatchBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace TESTProjectileBatchTest;
+
+	const int32 NumProjectiles = FCString::Atoi(*Parameters);
+	const int32 NumFrames = 60;
+	const float DeltaTime = 1.f / 60.f;
+	const TSubclassOf<ATESTProjectile> ProjectileClass = ATESTProjectile::StaticClass();
+
+	// Same shots as projectile actors spawned per shot, like fire path without pool
+	double ActorSpawnTime = 0.0;
+	double ActorTickTime = 0.0;
+	int32 ActorsLeft = 0;
+	{
+		FTEST_AutomationWorld World;
+		if (!TestTrue(TEXT("Wall is spawned"), SpawnWall(World.Get())))
+		{
+			return false;
+		}
+		APawn* Shooter = World->SpawnActor<APawn>(FVector(-1000.f, 0.f, 0.f), FRotator::ZeroRotator);
+		FActorSpawnParameters SpawnParameters;
+		SpawnParameters.Instigator = Shooter;
+		SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		FRandomStream Random(3);
+		double StartTime = FPlatformTime::Seconds();
+		for (int32 Index = 0; Index < NumProjectiles; ++Index)
+		{
+			FVector Location;
+			FRotator Rotation;
+			MakeShot(Random, Location, Rotation);
+			World->SpawnActor<ATESTProjectile>(ProjectileClass, Location, Rotation, SpawnParameters);
+		}
+		ActorSpawnTime = FPlatformTime::Seconds() - StartTime;
+		StartTime = FPlatformTime::Seconds();
+		World.Tick(DeltaTime, NumFrames);
+		ActorTickTime = FPlatformTime::Seconds() - StartTime;
+		ActorsLeft = CountFlyingActors(World.Get());
+	}
+
+	// Lightweight projectiles swept in one pass
+	double BatchSpawnTime = 0.0;
+	double BatchTickTime = 0.0;
+	int32 BatchLeft = 0;
+	{
+		FTEST_AutomationWorld World;
+		if (!TestTrue(TEXT("Wall is spawned"), SpawnWall(World.Get())))
+		{
+			return false;
+		}
+		APawn* Shooter = World->SpawnActor<APawn>(FVector(-1000.f, 0.f, 0.f), FRotator::ZeroRotator);
+		UTEST_ProjectileBatch* Batch = World->GetSubsystem<UTEST_ProjectileBatch>();
+		FRandomStream Random(3);
+		double StartTime = FPlatformTime::Seconds();
+		for (int32 Index = 0; Index < NumProjectiles; ++Index)
+		{
+			FVector Location;
+			FRotator Rotation;
+			MakeShot(Random, Location, Rotation);
+			Batch->FireProjectile(ProjectileClass, Location, Rotation, Shooter);
+		}
+		BatchSpawnTime = FPlatformTime::Seconds() - StartTime;
+		StartTime = FPlatformTime::Seconds();
+		World.Tick(DeltaTime, NumFrames);
+		BatchTickTime = FPlatformTime::Seconds() - StartTime;
+		BatchLeft = Batch->GetNumProjectiles();
+	}
+
+	// Every shot reaches wall within simulated second, so impacts are part of both timings
+	TestEqual(TEXT("All projectile actors hit wall"), ActorsLeft, 0);
+	TestEqual(TEXT("All lightweight projectiles hit wall"), BatchLeft, 0);
+	AddInfo(FString::Printf(TEXT("%d projectiles, %d frames: SpawnActor spawn %.3f ms + %.3f ms/frame, batch fire %.3f ms + %.3f ms/frame"),
+		NumProjectiles, NumFrames, ActorSpawnTime * 1000.0, ActorTickTime * 1000.0 / NumFrames, BatchSpawnTime * 1000.0, BatchTickTime * 1000.0 / NumFrames));
+	return true;
+}
+
+#endif
@@ -0,0 +1,185 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "EngineUtils.h"
+#include "HAL/PlatformTime.h"
+#include "UObject/UObjectArray.h"
+#include "TESTAutomationWorld.h"
+#include "TESTProjectile.h"
+#include "TEST_ProjectilePool.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace TESTProjectilePoolTest
+{
+	int32 CountProjectiles(UWorld* World)
+	{
+		int32 Count = 0;
+		for (TActorIterator<ATESTProjectile> It(World); It; ++It)
+		{
+			if (!It->IsPendingKill())
+			{
+				++Count;
+			}
+		}
+		return Count;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTESTProjectilePoolTest, "TEST.Projectile.Pool", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTESTProjectilePoolTest::RunTest(const FString& Parameters)
+{
+	using namespace TESTProjectilePoolTest;
+
+	FTEST_AutomationWorld World;
+	UTEST_ProjectilePool* Pool = World->GetSubsystem<UTEST_ProjectilePool>();
+	if (!TestNotNull(TEXT("Pool subsystem"), Pool))
+	{
+		return false;
+	}
+	Pool->InitialPoolSize = 2;
+	Pool->GrowSize = 2;
+	Pool->MaxPoolSize = 4;
+	const TSubclassOf<ATESTProjectile> ProjectileClass = ATESTProjectile::StaticClass();
+
+	// First shot fills pool with InitialPoolSize
+	ATESTProjectile* First = Pool->AcquireProjectile(ProjectileClass, FVector::ZeroVector, FRotator::ZeroRotator, nullptr, nullptr);
+	if (!TestNotNull(TEXT("First projectile"), First))
+	{
+		return false;
+	}
+	TestTrue(TEXT("First projectile is pooled"), First->IsPooled());
+	TestTrue(TEXT("First projectile is launched"), First->IsLaunched());
+	TestEqual(TEXT("Projectiles after first shot"), CountProjectiles(World.Get()), 2);
+
+	// Released projectile is parked and reused by next shot, nothing is spawned
+	Pool->ReleaseProjectile(First);
+	TestFalse(TEXT("Released projectile is parked"), First->IsLaunched());
+	TestFalse(TEXT("Released projectile has no collision"), First->GetActorEnableCollision());
+	ATESTProjectile* Reused = Pool->AcquireProjectile(ProjectileClass, FVector(100.f, 0.f, 0.f), FRotator::ZeroRotator, nullptr, nullptr);
+	TestEqual(TEXT("Released projectile is reused"), Reused, First);
+	TestEqual(TEXT("Reused projectile is moved to launch location"), Reused->GetActorLocation(), FVector(100.f, 0.f, 0.f));
+	TestEqual(TEXT("Projectiles after reuse"), CountProjectiles(World.Get()), 2);
+
+	// Pool grows by GrowSize up to MaxPoolSize
+	TArray<ATESTProjectile*> InFlight = { Reused };
+	for (int32 Index = 0; Index < 3; ++Index)
+	{
+		InFlight.Add(Pool->AcquireProjectile(ProjectileClass, FVector::ZeroVector, FRotator::ZeroRotator, nullptr, nullptr));
+	}
+	TestEqual(TEXT("Pooled projectiles at limit"), Pool->GetNumPooled(ProjectileClass), 4);
+	TestEqual(TEXT("Free projectiles at limit"), Pool->GetNumFree(ProjectileClass), 0);
+
+	// Full pool spawns projectile which is destroyed instead of parked
+	ATESTProjectile* Overflow = Pool->AcquireProjectile(ProjectileClass, FVector::ZeroVector, FRotator::ZeroRotator, nullptr, nullptr);
+	if (!TestNotNull(TEXT("Overflow projectile"), Overflow))
+	{
+		return false;
+	}
+	TestFalse(TEXT("Overflow projectile is not pooled"), Overflow->IsPooled());
+	Overflow->ReleaseOrDestroy();
+	TestTrue(TEXT("Overflow projectile is destroyed"), Overflow->IsPendingKill());
+
+	// Every pooled projectile goes back, double release is ignored
+	for (ATESTProjectile* Projectile : InFlight)
+	{
+		Projectile->ReleaseOrDestroy();
+	}
+	InFlight[0]->ReleaseOrDestroy();
+	TestEqual(TEXT("Free projectiles after release"), Pool->GetNumFree(ProjectileClass), 4);
+	TestEqual(TEXT("Pooled projectiles stay alive"), CountProjectiles(World.Get()), 4);
+	Pool->ReleaseProjectile(InFlight[1]);
+	TestEqual(TEXT("Direct second release is ignored"), Pool->GetNumFree(ProjectileClass), 4);
+
+	// Pooled projectile destroyed from outside frees its place in pool
+	ATESTProjectile* Destroyed = Pool->AcquireProjectile(ProjectileClass, FVector::ZeroVector, FRotator::ZeroRotator, nullptr, nullptr);
+	Destroyed->Destroy();
+	TestEqual(TEXT("Destroyed projectile leaves pool"), Pool->GetNumPooled(ProjectileClass), 3);
+	TestEqual(TEXT("Destroyed projectile is not free"), Pool->GetNumFree(ProjectileClass), 3);
+
+	// Expired life span parks projectile too
+	ATESTProjectile* Expiring = Pool->AcquireProjectile(ProjectileClass, FVector::ZeroVector, FRotator::ZeroRotator, nullptr, nullptr);
+	World.Tick(0.5f, 8);
+	TestFalse(TEXT("Expired projectile is parked"), Expiring->IsLaunched());
+	TestFalse(TEXT("Expired projectile is not destroyed"), Expiring->IsPendingKill());
+
+	// Pool grows again into place of destroyed projectile
+	for (int32 Index = 0; Index < 3; ++Index)
+	{
+		Pool->AcquireProjectile(ProjectileClass, FVector::ZeroVector, FRotator::ZeroRotator, nullptr, nullptr);
+	}
+	ATESTProjectile* Regrown = Pool->AcquireProjectile(ProjectileClass, FVector::ZeroVector, FRotator::ZeroRotator, nullptr, nullptr);
+	TestTrue(TEXT("Pool refills place of destroyed projectile"), Regrown != nullptr && Regrown->IsPooled());
+	TestEqual(TEXT("Pooled projectiles back at limit"), Pool->GetNumPooled(ProjectileClass), 4);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTESTProjectilePoolBenchmark, "TEST.Projectile.Pool.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FTESTProjectilePoolBenchmark::RunTest(const FString& Parameters)
+{
+	const int32 NumShots = 5000;
+	const int32 ShotsPerFrame = 10;
+	const int32 GarbageInterval = 30;
+	const float DeltaTime = 1.f / 60.f;
+	const float ShotLifeSpan = 0.5f;
+	const TSubclassOf<ATESTProjectile> ProjectileClass = ATESTProjectile::StaticClass();
+
+	for (const bool bPooled : { false, true })
+	{
+		FTEST_AutomationWorld World;
+		UTEST_ProjectilePool* Pool = World->GetSubsystem<UTEST_ProjectilePool>();
+		FRandomStream Random(7);
+		const int32 BaseObjects = GUObjectArray.GetObjectArrayNumMinusAvailable();
+		int32 PeakObjects = BaseObjects;
+		double SpawnTime = 0.0;
+		double GarbageTime = 0.0;
+		double MaxGarbageTime = 0.0;
+		int32 Frame = 0;
+
+		// Shots fly shorter than class life span so pool stays under its limit
+		for (int32 Shot = 0; Shot < NumShots || Frame % GarbageInterval != 0; )
+		{
+			const double SpawnStart = FPlatformTime::Seconds();
+			for (int32 Index = 0; Index < ShotsPerFrame && Shot < NumShots; ++Index, ++Shot)
+			{
+				const FVector Location = Random.VRand() * 1000.f;
+				const FRotator Rotation = Random.VRand().Rotation();
+				ATESTProjectile* Projectile = bPooled
+					? Pool->AcquireProjectile(ProjectileClass, Location, Rotation, nullptr, nullptr)
+					: World->SpawnActor<ATESTProjectile>(ProjectileClass, Location, Rotation);
+				if (Projectile != nullptr)
+				{
+					Projectile->SetLifeSpan(ShotLifeSpan);
+				}
+			}
+			SpawnTime += FPlatformTime::Seconds() - SpawnStart;
+
+			World.Tick(DeltaTime);
+			PeakObjects = FMath::Max(PeakObjects, GUObjectArray.GetObjectArrayNumMinusAvailable());
+
+			// Garbage collection at fixed interval, as engine does during match
+			if (++Frame % GarbageInterval == 0)
+			{
+				const double GarbageStart = FPlatformTime::Seconds();
+				CollectGarbage(GARBAGE_COLLECTION_KEEPFLAGS);
+				const double Pause = FPlatformTime::Seconds() - GarbageStart;
+				GarbageTime += Pause;
+				MaxGarbageTime = FMath::Max(MaxGarbageTime, Pause);
+			}
+		}
+
+		AddInfo(FString::Printf(TEXT("%s: %d shots, spawn %.3f us per shot, GC %.3f ms total, %.3f ms worst pause, peak UObjects +%d"),
+			bPooled ? TEXT("Pooled") : TEXT("SpawnActor"), NumShots, SpawnTime * 1000000.0 / NumShots, GarbageTime * 1000.0, MaxGarbageTime * 1000.0, PeakObjects - BaseObjects));
+		if (bPooled)
+		{
+			TestTrue(TEXT("Pool stays under its limit"), Pool->MaxPoolSize == 0 || Pool->GetNumPooled(ProjectileClass) < Pool->MaxPoolSize);
+		}
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "TESTAutomationWorld.h"
+#include "TEST_Destructable.h"
+#include "TEST_DestructableRegistry.h"
+#include "TEST_RadialDamage.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace TESTRadialDamageTest
+{
+	// Explosive destructables packed into one registry cell, every explosion reaches many neighbours
+	void SpawnExplosiveCluster(UWorld* World, int32 Count, float Spacing, TArray<ATEST_Destructable*>& OutDestructables)
+	{
+		const int32 Side = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(Count)));
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			const FVector Location(10.f + (Index % Side) * Spacing, 10.f + (Index / Side) * Spacing, 0.f);
+			ATEST_Destructable* Destructable = World->SpawnActorDeferred<ATEST_Destructable>(ATEST_Destructable::StaticClass(), FTransform(Location));
+			Destructable->bExplodeOnBreak = true;
+			Destructable->ExplosionDamage = Destructable->MaxHealth * 5.f;
+			Destructable->FinishSpawning(FTransform(Location));
+			OutDestructables.Add(Destructable);
+		}
+	}
+
+	int32 CountBroken(const TArray<ATEST_Destructable*>& Destructables)
+	{
+		int32 Count = 0;
+		for (const ATEST_Destructable* Destructable : Destructables)
+		{
+			Count += Destructable->GetState() == ETESTDestructableState::Broken ? 1 : 0;
+		}
+		return Count;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTESTRadialDamageChainBenchmark, "TEST.Destruction.RadialDamage.Chain.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FTESTRadialDamageChainBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace TESTRadialDamageTest;
+
+	const int32 NumDestructables = 200;
+	const int32 MaxFrames = 1000;
+	const float DeltaTime = 1.f / 30.f;
+
+	FTEST_AutomationWorld World;
+	UTEST_RadialDamage* RadialDamage = World->GetSubsystem<UTEST_RadialDamage>();
+	UTEST_DestructableRegistry* Registry = World->GetSubsystem<UTEST_DestructableRegistry>();
+	const float Spacing = Registry->CellSize / (FMath::Sqrt(static_cast<float>(NumDestructables)) + 1.f);
+	TArray<ATEST_Destructable*> Destructables;
+	SpawnExplosiveCluster(World.Get(), NumDestructables, Spacing, Destructables);
+	if (!TestEqual(TEXT("Destructables registered"), Registry->Num(), NumDestructables))
+	{
+		return false;
+	}
+
+	// One explosion in the middle starts chain reaction
+	const FTEST_ExplosionParams& Params = Destructables[0]->Explosion;
+	const FVector Center(Registry->CellSize * 0.5f, Registry->CellSize * 0.5f, 0.f);
+	double StartTime = FPlatformTime::Seconds();
+	RadialDamage->ApplyExplosion(Center, Destructables[0]->ExplosionDamage, Params, nullptr, nullptr, nullptr);
+	double TotalTime = FPlatformTime::Seconds() - StartTime;
+	double WorstTime = TotalTime;
+
+	// Damage is applied on next tick, so queue can be empty while chain still goes on
+	int32 Frames = 0;
+	int32 NumBroken = 0;
+	int32 PreviousBroken = INDEX_NONE;
+	while (Frames < MaxFrames && (RadialDamage->GetNumPendingExplosions() > 0 || NumBroken != PreviousBroken))
+	{
+		PreviousBroken = NumBroken;
+		StartTime = FPlatformTime::Seconds();
+		World.Tick(DeltaTime);
+		const double FrameTime = FPlatformTime::Seconds() - StartTime;
+		TotalTime += FrameTime;
+		WorstTime = FMath::Max(WorstTime, FrameTime);
+		NumBroken = CountBroken(Destructables);
+		++Frames;
+	}
+
+	TestEqual(TEXT("Chain reaction finished"), RadialDamage->GetNumPendingExplosions(), 0);
+	TestTrue(TEXT("Chain reaction spread"), NumBroken > 1);
+	AddInfo(FString::Printf(TEXT("%d explosive destructables in one cell: %d broken in %d frames, %.3f ms total, worst frame %.3f ms, %d explosions dropped (limit %d per frame, %d pending)"),
+		NumDestructables, NumBroken, Frames, TotalTime * 1000.0, WorstTime * 1000.0, RadialDamage->GetNumDroppedExplosions(), RadialDamage->MaxExplosionsPerFrame, RadialDamage->MaxPendingExplosions));
+	return true;
+}
+
+#endif
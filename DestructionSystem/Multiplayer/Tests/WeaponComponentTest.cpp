@@ -0,0 +1,123 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "TEST_WeaponComponent.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace TESTWeaponComponentTest
+{
+	// Weapon without world, driven by Now
+	UTEST_WeaponComponent* MakeWeapon(ETESTFireMode FireMode, float FireInterval, int32 Ammo, float& Now)
+	{
+		UTEST_WeaponComponent* Weapon = NewObject<UTEST_WeaponComponent>();
+		Weapon->FireMode = FireMode;
+		Weapon->FireInterval = FireInterval;
+		Weapon->Ammo = Ammo;
+		Weapon->SetClockOverride([&Now]() { return Now; });
+		return Weapon;
+	}
+
+	// Shots fired by calling TryFire every Step seconds until Duration, like owner Tick.
+	// Tests use times exact in binary, so cooldown ends exactly on a step
+	int32 FireFor(UTEST_WeaponComponent* Weapon, float& Now, float Duration, float Step)
+	{
+		int32 Shots = 0;
+		for (const float End = Now + Duration; Now < End; Now += Step)
+		{
+			Shots += Weapon->TryFire(Weapon->GetTime()) ? 1 : 0;
+		}
+		return Shots;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTESTWeaponFireModesTest, "TEST.Weapon.FireModes", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTESTWeaponFireModesTest::RunTest(const FString& Parameters)
+{
+	using namespace TESTWeaponComponentTest;
+
+	// Single fires once per press, press during cooldown is dropped on release
+	{
+		float Now = 0.f;
+		UTEST_WeaponComponent* Weapon = MakeWeapon(ETESTFireMode::Single, 1.f, 10, Now);
+		Weapon->PressTrigger();
+		TestTrue(TEXT("Single fires on press"), Weapon->TryFire(Weapon->GetTime()));
+		TestFalse(TEXT("Single has no more shots"), Weapon->HasPendingShots());
+		Now = 0.5f;
+		Weapon->PressTrigger();
+		TestFalse(TEXT("Single waits for cooldown"), Weapon->TryFire(Weapon->GetTime()));
+		Weapon->ReleaseTrigger();
+		TestFalse(TEXT("Release drops press during cooldown"), Weapon->HasPendingShots());
+		Now = 1.f;
+		Weapon->PressTrigger();
+		TestTrue(TEXT("Single fires after cooldown"), Weapon->TryFire(Weapon->GetTime()));
+		TestEqual(TEXT("Single ammo"), Weapon->GetAmmo(), 8);
+	}
+
+	// Burst finishes after release, one shot per interval
+	{
+		float Now = 0.f;
+		UTEST_WeaponComponent* Weapon = MakeWeapon(ETESTFireMode::Burst, 0.125f, 10, Now);
+		Weapon->BurstCount = 3;
+		Weapon->PressTrigger();
+		Weapon->ReleaseTrigger();
+		TestEqual(TEXT("Burst shots in one second"), FireFor(Weapon, Now, 1.f, 0.03125f), 3);
+		TestFalse(TEXT("Burst is finished"), Weapon->HasPendingShots());
+		TestEqual(TEXT("Burst ammo"), Weapon->GetAmmo(), 7);
+	}
+
+	// Auto fires at fire rate until release or empty magazine
+	{
+		float Now = 0.f;
+		UTEST_WeaponComponent* Weapon = MakeWeapon(ETESTFireMode::Auto, 0.125f, 30, Now);
+		Weapon->PressTrigger();
+		TestEqual(TEXT("Auto shots in half second"), FireFor(Weapon, Now, 0.5f, 0.03125f), 4);
+		Weapon->ReleaseTrigger();
+		TestEqual(TEXT("Auto stops on release"), FireFor(Weapon, Now, 0.5f, 0.03125f), 0);
+		Weapon->PressTrigger();
+		TestEqual(TEXT("Auto fires rest of ammo"), FireFor(Weapon, Now, 5.f, 0.03125f), 26);
+		TestFalse(TEXT("Empty weapon stops auto fire"), Weapon->HasPendingShots());
+	}
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTESTWeaponValidateShotTest, "TEST.Weapon.ValidateShot", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTESTWeaponValidateShotTest::RunTest(const FString& Parameters)
+{
+	using namespace TESTWeaponComponentTest;
+
+	float Now = 10.f;
+	UTEST_WeaponComponent* Weapon = MakeWeapon(ETESTFireMode::Auto, 0.5f, 3, Now);
+	Weapon->MaxShotAge = 1.f;
+	Weapon->FireIntervalTolerance = 0.05f;
+	float ShotTime = 0.f;
+
+	// Client time outside of accepted window
+	TestFalse(TEXT("Stale shot is rejected"), Weapon->ValidateShot(Now - 1.5f, Weapon->GetTime(), ShotTime));
+	TestFalse(TEXT("Shot from future is rejected"), Weapon->ValidateShot(Now + 0.2f, Weapon->GetTime(), ShotTime));
+	TestEqual(TEXT("Rejected shots keep ammo"), Weapon->GetAmmo(), 3);
+
+	TestTrue(TEXT("Shot inside window is accepted"), Weapon->ValidateShot(Now - 0.3f, Weapon->GetTime(), ShotTime));
+	TestEqual(TEXT("Accepted shot keeps client time"), ShotTime, Now - 0.3f);
+
+	// Too fast shot moves to end of cooldown, rejected while that is in future
+	TestFalse(TEXT("Shot faster than fire rate is rejected"), Weapon->ValidateShot(Now - 0.2f, Weapon->GetTime(), ShotTime));
+	Now += 0.2f;
+	TestTrue(TEXT("Fast shot is accepted once cooldown ends"), Weapon->ValidateShot(Now - 0.5f, Weapon->GetTime(), ShotTime));
+	TestEqual(TEXT("Fast shot is clamped to cooldown end"), ShotTime, 10.2f, 0.001f);
+	TestEqual(TEXT("Next shot waits for clamped shot"), Weapon->GetNextFireTime(), 10.7f, 0.001f);
+
+	// Empty weapon rejects everything
+	Now += 1.f;
+	TestTrue(TEXT("Last shot is accepted"), Weapon->ValidateShot(Now, Weapon->GetTime(), ShotTime));
+	Now += 1.f;
+	TestFalse(TEXT("Shot without ammo is rejected"), Weapon->ValidateShot(Now, Weapon->GetTime(), ShotTime));
+	TestEqual(TEXT("No ammo left"), Weapon->GetAmmo(), 0);
+	return true;
+}
+
+#endif
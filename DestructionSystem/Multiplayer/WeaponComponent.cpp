@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TEST_WeaponComponent.h"
+#include "GameFramework/GameStateBase.h"
+#include "Engine/World.h"
+
+UTEST_WeaponComponent::UTEST_WeaponComponent()
+{
+	// Owner drives firing, cooldown needs no tick
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UTEST_WeaponComponent::PressTrigger()
+{
+	switch (FireMode)
+	{
+	case ETESTFireMode::Single:
+		ShotsLeft = 1;
+		break;
+	case ETESTFireMode::Burst:
+		// Running burst is not restarted
+		if (ShotsLeft == 0)
+		{
+			ShotsLeft = FMath::Max(BurstCount, 1);
+		}
+		break;
+	case ETESTFireMode::Auto:
+		ShotsLeft = -1;
+		break;
+	}
+}
+
+void UTEST_WeaponComponent::ReleaseTrigger()
+{
+	// Burst finishes on its own, single press during cooldown is dropped
+	if (FireMode != ETESTFireMode::Burst)
+	{
+		ShotsLeft = 0;
+	}
+}
+
+bool UTEST_WeaponComponent::TryFire(float Time)
+{
+	if (ShotsLeft == 0 || Ammo <= 0 || !IsCooledDown(Time))
+	{
+		return false;
+	}
+	ConsumeShot(Time);
+	if (ShotsLeft > 0)
+	{
+		--ShotsLeft;
+	}
+	if (Ammo == 0)
+	{
+		ShotsLeft = 0;
+	}
+	return true;
+}
+
+bool UTEST_WeaponComponent::ValidateShot(float ShotTime, float ServerTime, float& OutShotTime)
+{
+	// Stale shot is rejected, client can not claim arbitrary old time
+	if (Ammo <= 0 || ShotTime < ServerTime - MaxShotAge)
+	{
+		return false;
+	}
+	// Shot faster than fire rate waits for cooldown, and is rejected if that is in future
+	OutShotTime = FMath::Max(ShotTime, GetNextFireTime());
+	if (OutShotTime > ServerTime + FireIntervalTolerance)
+	{
+		return false;
+	}
+	ConsumeShot(OutShotTime);
+	return true;
+}
+
+float UTEST_WeaponComponent::GetTime() const
+{
+	if (ClockOverride)
+	{
+		return ClockOverride();
+	}
+	const UWorld* World = GetWorld();
+	const AGameStateBase* GameState = World->GetGameState();
+	return GameState != nullptr ? GameState->GetServerWorldTimeSeconds() : World->GetTimeSeconds();
+}
+
+bool UTEST_WeaponComponent::IsCooledDown(float Time) const
+{
+	return Time >= GetNextFireTime();
+}
+
+void UTEST_WeaponComponent::ConsumeShot(float Time)
+{
+	--Ammo;
+	LastFireTime = Time;
+}
@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "TEST_WeaponComponent.generated.h"
+
+// How many shots one trigger press fires
+UENUM(BlueprintType)
+enum class ETESTFireMode : uint8
+{
+	Single,
+	Burst,
+	Auto
+};
+
+/**
+ * Ammo, fire rate and fire mode of weapon. Cooldown is kept as time of
+ * last shot, nothing is scheduled per shot. Owner asks TryFire when
+ * it wants to shoot, server checks shots sent by client with ValidateShot.
+ * Clock can be replaced to drive component without world
+ */
+UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
+class TEST_API UTEST_WeaponComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UTEST_WeaponComponent();
+
+	// Trigger input, Single and Burst keep firing their shots after release
+	void PressTrigger();
+	void ReleaseTrigger();
+
+	// Fire if trigger wants shot, there is ammo and cooldown passed.
+	// Consumes ammo, called every frame by owner while HasPendingShots
+	bool TryFire(float Time);
+
+	// True while trigger sequence has shots left to fire
+	bool HasPendingShots() const { return ShotsLeft != 0; }
+
+	// Server check of shot fired by client at ShotTime, consumes ammo if accepted.
+	// Shot older than MaxShotAge or from future is rejected, shot inside cooldown
+	// of last accepted shot is moved to its end. OutShotTime is accepted time
+	bool ValidateShot(float ShotTime, float ServerTime, float& OutShotTime);
+
+	// Earliest time next shot can be fired, without tolerance
+	float GetNextFireTime() const { return LastFireTime + FireInterval; }
+
+	// Current time, server world time or clock override
+	float GetTime() const;
+
+	// Replace clock, empty function restores world time
+	void SetClockOverride(TFunction<float()> InClock) { ClockOverride = MoveTemp(InClock); }
+
+	int32 GetAmmo() const { return Ammo; }
+
+	// Set ammo, used by client to apply ammo confirmed by server
+	void SetAmmo(int32 NewAmmo) { Ammo = FMath::Max(NewAmmo, 0); }
+
+	void AddAmmo(int32 Amount) { SetAmmo(Ammo + Amount); }
+
+	// Ammo at start
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Weapon)
+	int32 Ammo = 10;
+
+	// Seconds between shots
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Weapon, meta = (ClampMin = "0.0"))
+	float FireInterval = 1.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Weapon)
+	ETESTFireMode FireMode = ETESTFireMode::Single;
+
+	// Shots of one burst
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Weapon, meta = (ClampMin = "1", EditCondition = "FireMode == ETESTFireMode::Burst"))
+	int32 BurstCount = 3;
+
+	// How far accepted time of shot, its time or end of cooldown if later,
+	// may be ahead of server time before server rejects it
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Weapon, meta = (ClampMin = "0.0"))
+	float FireIntervalTolerance = 0.05f;
+
+	// Server rejects shots fired longer ago, covers resends of lost fire commands
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Weapon, meta = (ClampMin = "0.0"))
+	float MaxShotAge = 1.f;
+
+private:
+	bool IsCooledDown(float Time) const;
+
+	void ConsumeShot(float Time);
+
+	// Shots left in current trigger sequence, -1 until release for Auto
+	int32 ShotsLeft = 0;
+
+	float LastFireTime = -MAX_flt;
+
+	TFunction<float()> ClockOverride;
+};
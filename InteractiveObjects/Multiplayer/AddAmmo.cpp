@@ -3,9 +3,14 @@
 
 #include "TEST_AddAmmo.h"
 
+ATEST_AddAmmo::ATEST_AddAmmo()
+{
+	InteractionCapabilities |= ETESTInteractionCapability::Consumable;
+}
+
 void ATEST_AddAmmo::OnInteract()
 {
 	// Add ammunition and destroy
-	InteractiveInstigator->CurrentAmmo += AmmoValue;
+	InteractiveInstigator->AddAmmo(AmmoValue);
 	Destroy();
 }
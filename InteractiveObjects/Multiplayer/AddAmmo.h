@@ -15,6 +15,8 @@ class TEST_API ATEST_AddAmmo : public ATEST_Interactive
 	GENERATED_BODY()
 
 public:
+	ATEST_AddAmmo();
+
 	// Function inherited from ATEST_Interactive to 
 	// do action on client side
 	void OnInteract() override;
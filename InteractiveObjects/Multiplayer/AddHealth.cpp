@@ -3,6 +3,11 @@
 
 #include "TEST_AddHealth.h"
 
+ATEST_AddHealth::ATEST_AddHealth()
+{
+	InteractionCapabilities |= ETESTInteractionCapability::Consumable;
+}
+
 void ATEST_AddHealth::OnInteract()
 {
 	// Heal player and destroy self
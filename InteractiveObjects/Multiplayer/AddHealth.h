@@ -14,6 +14,8 @@ class TEST_API ATEST_AddHealth : public ATEST_Interactive
 {
 	GENERATED_BODY()
 public:
+	ATEST_AddHealth();
+
 	// Function inherited from ATEST_Interactive to 
 	// do action on client side
 	void OnInteract() override; 
@@ -0,0 +1,206 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TEST_InteractionFocusComponent.h"
+#include "TEST_InteractiveRegistry.h"
+#include "HAL/PlatformTime.h"
+
+static TAutoConsoleVariable<int32> CVarTESTInteractionAsyncTrace(
+	TEXT("TEST.Interaction.AsyncTrace"),
+	1,
+	TEXT("Use async batched traces for interaction focus.\n")
+	TEXT("0: trace on game thread in component tick, 1: async trace with result on next frame"),
+	ECVF_Default);
+
+DECLARE_STATS_GROUP(TEXT("TEST Interaction"), STATGROUP_TESTInteraction, STATCAT_Advanced);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Focus traces per frame"), STAT_TESTFocusTraces, STATGROUP_TESTInteraction);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Focus traces skipped per frame"), STAT_TESTFocusTracesSkipped, STATGROUP_TESTInteraction);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Focus traces per second"), STAT_TESTFocusTracesPerSecond, STATGROUP_TESTInteraction);
+
+#if STATS
+// Counter stats are cleared every frame, so traces are also summed over one second of real time
+static void UpdateFocusTraceRate(bool bTraced)
+{
+	static double WindowStart = FPlatformTime::Seconds();
+	static uint32 NumTraces = 0;
+
+	NumTraces += bTraced ? 1 : 0;
+	const double Now = FPlatformTime::Seconds();
+	if (Now - WindowStart >= 1.0)
+	{
+		SET_DWORD_STAT(STAT_TESTFocusTracesPerSecond, FMath::RoundToInt(NumTraces / (Now - WindowStart)));
+		WindowStart = Now;
+		NumTraces = 0;
+	}
+}
+#endif
+
+UTEST_InteractionFocusComponent::UTEST_InteractionFocusComponent()
+{
+	PrimaryComponentTick.bCanEverTick = true;
+	// Owner enable tick after it becomes locally controlled
+	PrimaryComponentTick.bStartWithTickEnabled = false;
+
+	ViewComponent = nullptr;
+	LastTraceLocation = FVector::ZeroVector;
+	LastTraceDirection = FVector::ZeroVector;
+	LastTraceTime = 0.f;
+	bDirty = true;
+	AngleThresholdCos = 1.f;
+
+	AsyncTraceDelegate.BindUObject(this, &UTEST_InteractionFocusComponent::OnAsyncTraceDone);
+}
+
+void UTEST_InteractionFocusComponent::SetFocusEnabled(bool bEnabled)
+{
+	SetComponentTickEnabled(bEnabled);
+	AngleThresholdCos = FMath::Cos(FMath::DegreesToRadians(AngleThreshold));
+	bDirty = true;
+	if (!bEnabled)
+	{
+		// Result of pending trace will be ignored
+		PendingTrace = FTraceHandle();
+		SetFocusedActor(nullptr);
+		SET_DWORD_STAT(STAT_TESTFocusTracesPerSecond, 0);
+	}
+}
+
+void UTEST_InteractionFocusComponent::SetViewComponent(USceneComponent* InViewComponent)
+{
+	ViewComponent = InViewComponent;
+	bDirty = true;
+}
+
+void UTEST_InteractionFocusComponent::OnProximityBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+{
+	if (OtherActor != GetOwner())
+	{
+		bDirty = true;
+	}
+}
+
+void UTEST_InteractionFocusComponent::OnProximityEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex)
+{
+	if (OtherActor != GetOwner())
+	{
+		bDirty = true;
+	}
+}
+
+void UTEST_InteractionFocusComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
+{
+	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
+
+	// Wait for result of previous async trace
+	if (PendingTrace.IsValid())
+	{
+		return;
+	}
+
+	const bool bTraced = ShouldTrace() && TraceFocus();
+	if (!bTraced)
+	{
+		INC_DWORD_STAT(STAT_TESTFocusTracesSkipped);
+	}
+#if STATS
+	UpdateFocusTraceRate(bTraced);
+#endif
+}
+
+bool UTEST_InteractionFocusComponent::ShouldTrace() const
+{
+	if (ViewComponent == nullptr)
+	{
+		return false;
+	}
+	// Focused item was taken or destroyed
+	if (bDirty || FocusedActor.IsStale())
+	{
+		return true;
+	}
+	if (MaxTraceInterval > 0.f && GetWorld()->GetTimeSeconds() - LastTraceTime >= MaxTraceInterval)
+	{
+		return true;
+	}
+	const FVector Location = ViewComponent->GetComponentLocation();
+	if (!Location.Equals(LastTraceLocation, LocationThreshold))
+	{
+		return true;
+	}
+	return (ViewComponent->GetForwardVector() | LastTraceDirection) < AngleThresholdCos;
+}
+
+bool UTEST_InteractionFocusComponent::TraceFocus()
+{
+	// Get Camera Location and Forward Vector to cast ray
+	LastTraceLocation = ViewComponent->GetComponentLocation();
+	LastTraceDirection = ViewComponent->GetForwardVector();
+	LastTraceTime = GetWorld()->GetTimeSeconds();
+	bDirty = false;
+
+	// Nothing interactive in range, so nothing to focus
+	if (bUseRegistryPrecheck)
+	{
+		UTEST_InteractiveRegistry* Registry = GetWorld()->GetSubsystem<UTEST_InteractiveRegistry>();
+		if (Registry != nullptr && !Registry->HasAnyInRadius(LastTraceLocation, TraceDistance + PrecheckMargin))
+		{
+			SetFocusedActor(nullptr);
+			return false;
+		}
+	}
+
+	INC_DWORD_STAT(STAT_TESTFocusTraces);
+
+	// Forward Vector is multipled by lenght of ray
+	const FVector End = LastTraceLocation + LastTraceDirection * TraceDistance;
+	FCollisionQueryParams CollisionParams(SCENE_QUERY_STAT(TESTInteractionFocus));
+	// Ignore owner
+	CollisionParams.AddIgnoredActor(GetOwner());
+
+	if (CVarTESTInteractionAsyncTrace.GetValueOnGameThread() != 0)
+	{
+		PendingTrace = GetWorld()->AsyncLineTraceByChannel(EAsyncTraceType::Single, LastTraceLocation, End, ECC_Visibility, CollisionParams, FCollisionResponseParams::DefaultResponseParam, &AsyncTraceDelegate);
+		return true;
+	}
+
+	FHitResult Hit;
+	if (GetWorld()->LineTraceSingleByChannel(Hit, LastTraceLocation, End, ECC_Visibility, CollisionParams))
+	{
+		SetFocusedActor(Hit.GetActor());
+	}
+	else
+	{
+		SetFocusedActor(nullptr);
+	}
+	return true;
+}
+
+void UTEST_InteractionFocusComponent::OnAsyncTraceDone(const FTraceHandle& Handle, FTraceDatum& Datum)
+{
+	// Component was disabled or other trace was requested
+	if (Handle != PendingTrace)
+	{
+		return;
+	}
+	PendingTrace = FTraceHandle();
+
+	AActor* HitActor = nullptr;
+	for (const FHitResult& Hit : Datum.OutHits)
+	{
+		if (Hit.bBlockingHit)
+		{
+			HitActor = Hit.GetActor();
+			break;
+		}
+	}
+	SetFocusedActor(HitActor);
+}
+
+void UTEST_InteractionFocusComponent::SetFocusedActor(AActor* NewFocus)
+{
+	if (FocusedActor.Get() != NewFocus || FocusedActor.IsStale())
+	{
+		FocusedActor = NewFocus;
+		OnFocusChanged.Broadcast(NewFocus);
+	}
+}
@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Engine/World.h"
+#include "TEST_InteractionFocusComponent.generated.h"
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FTESTFocusChanged, AActor*, FocusedActor);
+
+/**
+ * Finds actor pointed by player camera. Trace is done only
+ * when view moved more than threshold, something entered
+ * proximity or focus is too old. Works only on locally controlled pawn.
+ * Traces are async by default, engine runs all async traces from
+ * one frame as a batch and result is used on next frame
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class TEST_API UTEST_InteractionFocusComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UTEST_InteractionFocusComponent();
+
+	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
+
+	// Enable tracing, owner call it after it becomes locally controlled
+	void SetFocusEnabled(bool bEnabled);
+
+	// Component which location and forward vector are used for trace
+	void SetViewComponent(USceneComponent* InViewComponent);
+
+	// Force trace on next tick
+	void MarkDirty() { bDirty = true; }
+
+	// Bind to proximity overlap events so focus is refreshed when something comes close
+	UFUNCTION()
+	void OnProximityBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
+
+	UFUNCTION()
+	void OnProximityEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex);
+
+	// Actor hit by last trace, null if nothing
+	AActor* GetFocusedActor() const { return FocusedActor.Get(); }
+
+	// Called when focused actor changed
+	UPROPERTY(BlueprintAssignable, Category = "Interaction")
+	FTESTFocusChanged OnFocusChanged;
+
+	// Length of trace
+	UPROPERTY(EditAnywhere, Category = "Interaction")
+	float TraceDistance = 250.f;
+
+	// Minimal view movement to trace again
+	UPROPERTY(EditAnywhere, Category = "Interaction")
+	float LocationThreshold = 2.f;
+
+	// Minimal view rotation in degrees to trace again
+	UPROPERTY(EditAnywhere, Category = "Interaction")
+	float AngleThreshold = 0.5f;
+
+	// Skip trace if UTEST_InteractiveRegistry has nothing interactive in range
+	UPROPERTY(EditAnywhere, Category = "Interaction")
+	bool bUseRegistryPrecheck = true;
+
+	// Registry knows only object origins, add size of biggest interactive object
+	UPROPERTY(EditAnywhere, Category = "Interaction")
+	float PrecheckMargin = 100.f;
+
+	// Max time between traces, catches moving objects which
+	// are already in proximity, 0 to disable
+	UPROPERTY(EditAnywhere, Category = "Interaction")
+	float MaxTraceInterval = 0.25f;
+
+private:
+	// Check if view changed enough to trace again
+	bool ShouldTrace() const;
+
+	// Trace from view and update focused actor, false if registry precheck skipped the trace
+	bool TraceFocus();
+
+	// Set focused actor and notify if changed
+	void SetFocusedActor(AActor* NewFocus);
+
+	// Result of async trace, delivered on next frame
+	void OnAsyncTraceDone(const FTraceHandle& Handle, FTraceDatum& Datum);
+
+	// Async trace waiting for result
+	FTraceHandle PendingTrace;
+	FTraceDelegate AsyncTraceDelegate;
+
+	UPROPERTY(Transient)
+	USceneComponent* ViewComponent;
+
+	TWeakObjectPtr<AActor> FocusedActor;
+
+	// View used in last trace
+	FVector LastTraceLocation;
+	FVector LastTraceDirection;
+	float LastTraceTime;
+
+	// Something changed which needs new trace
+	bool bDirty;
+
+	// Cosine of AngleThreshold
+	float AngleThresholdCos;
+};
@@ -2,12 +2,22 @@
 
 
 #include "TEST_Interactive.h"
+#include "TEST_InteractiveRegistry.h"
 
 // Sets default values
 ATEST_Interactive::ATEST_Interactive()
 {
 	bReplicates = true;
 	PrimaryActorTick.bCanEverTick = false;
+	InteractionCapabilities |= ETESTInteractionCapability::Interactable;
+
+	// Idle items are not considered for replication until someone interact,
+	// placed items start dormant, spawned ones after first replication
+	NetDormancy = DORM_Initial;
+	NetUpdateFrequency = 2.f;
+	MinNetUpdateFrequency = 0.5f;
+	NetCullDistanceSquared = FMath::Square(5000.f);
+
 	ObjMesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("Interavtive Object"));
 	ObjMesh->BodyInstance.SetCollisionProfileName("IgnoreOnlyPawn");
 	ObjMesh->SetMobility(EComponentMobility::Movable);
@@ -19,6 +29,39 @@ ATEST_Interactive::ATEST_Interactive()
 	RootComponent = ObjMesh;
 }
 
+void ATEST_Interactive::BeginPlay()
+{
+	Super::BeginPlay();
+	// Initial dormancy works only for actors placed in level
+	if (HasAuthority() && !IsNetStartupActor())
+	{
+		SetNetDormancy(DORM_DormantAll);
+	}
+	if (UTEST_InteractiveRegistry* Registry = GetWorld()->GetSubsystem<UTEST_InteractiveRegistry>())
+	{
+		Registry->Register(this);
+		ObjMesh->TransformUpdated.AddUObject(this, &ATEST_Interactive::OnRootTransformUpdated);
+	}
+}
+
+void ATEST_Interactive::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UTEST_InteractiveRegistry* Registry = GetWorld()->GetSubsystem<UTEST_InteractiveRegistry>())
+	{
+		Registry->Unregister(this);
+	}
+	ObjMesh->TransformUpdated.RemoveAll(this);
+	Super::EndPlay(EndPlayReason);
+}
+
+void ATEST_Interactive::OnRootTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	if (UTEST_InteractiveRegistry* Registry = GetWorld()->GetSubsystem<UTEST_InteractiveRegistry>())
+	{
+		Registry->UpdateLocation(this);
+	}
+}
+
 void ATEST_Interactive::OnInteract()
 {
 }
@@ -29,6 +72,8 @@ void ATEST_Interactive::InteractBy(ATESTCharacter* Character)
 	if (Role == ROLE_Authority)
 	{
 		InteractiveInstigator = Character;
+		// Send new state once and stay dormant
+		FlushNetDormancy();
 		// Notify clients of the interaction
 		ClientInteractBy(Character);
 	}
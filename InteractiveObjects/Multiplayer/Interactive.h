@@ -7,10 +7,11 @@
 #include "Components/StaticMeshComponent.h"
 #include "TESTCharacter.h"
 #include "Engine/Canvas.h"
+#include "TEST_InteractionCapabilities.h"
 #include "TEST_Interactive.generated.h"
 
 UCLASS(Abstract)
-class TEST_API ATEST_Interactive : public AActor
+class TEST_API ATEST_Interactive : public ATEST_CapabilityActor
 {
 	GENERATED_BODY()
 	
@@ -40,7 +41,15 @@ public:
 	UFUNCTION(BlueprintAuthorityOnly, Category = "Interactive")
 	virtual void InteractBy(ATESTCharacter* Character);
 
+protected:
+	// Register in UTEST_InteractiveRegistry
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 private:
+	// Keep registry location up to date when object moves
+	void OnRootTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
 	// Invoke OnInteract and assign character to InteractiveInstigator on every client
 	UFUNCTION(NetMulticast, Reliable)
 	void ClientInteractBy(ATESTCharacter* Character);
@@ -0,0 +1,84 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TEST_InteractiveRegistry.h"
+#include "TEST_Interactive.h"
+
+DECLARE_CYCLE_STAT(TEXT("Interactive registry query"), STAT_TESTInteractiveRegistryQuery, STATGROUP_Game);
+
+void UTEST_InteractiveRegistry::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	Grid.SetCellSize(CellSize);
+}
+
+void UTEST_InteractiveRegistry::Deinitialize()
+{
+	Grid.Empty();
+	Super::Deinitialize();
+}
+
+void UTEST_InteractiveRegistry::Register(ATEST_Interactive* Interactive)
+{
+	Grid.Add(Interactive, Interactive->GetActorLocation());
+}
+
+void UTEST_InteractiveRegistry::Unregister(ATEST_Interactive* Interactive)
+{
+	Grid.Remove(Interactive);
+}
+
+void UTEST_InteractiveRegistry::UpdateLocation(ATEST_Interactive* Interactive)
+{
+	Grid.Update(Interactive, Interactive->GetActorLocation());
+}
+
+ATEST_Interactive* UTEST_InteractiveRegistry::FindNearestInCone(FVector Origin, FVector Direction, float MaxDistance, float HalfAngleDegrees, AActor* IgnoreActor) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_TESTInteractiveRegistryQuery);
+
+	const FVector ConeDirection = Direction.GetSafeNormal();
+	const float MinCos = FMath::Cos(FMath::DegreesToRadians(HalfAngleDegrees));
+
+	ATEST_Interactive* Nearest = nullptr;
+	float NearestDistanceSquared = MAX_flt;
+	Grid.ForEachInRadius(Origin, MaxDistance, [&](ATEST_Interactive* Interactive, const FVector& Location)
+	{
+		if (Interactive == IgnoreActor)
+		{
+			return;
+		}
+		const FVector ToInteractive = Location - Origin;
+		const float DistanceSquared = ToInteractive.SizeSquared();
+		if (DistanceSquared >= NearestDistanceSquared)
+		{
+			return;
+		}
+		// Object in origin is always inside cone
+		if (DistanceSquared > KINDA_SMALL_NUMBER && (ToInteractive * FMath::InvSqrt(DistanceSquared) | ConeDirection) < MinCos)
+		{
+			return;
+		}
+		Nearest = Interactive;
+		NearestDistanceSquared = DistanceSquared;
+	});
+	return Nearest;
+}
+
+void UTEST_InteractiveRegistry::GetInteractivesInRadius(FVector Origin, float Radius, TArray<ATEST_Interactive*>& OutInteractives) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_TESTInteractiveRegistryQuery);
+
+	OutInteractives.Reset();
+	Grid.ForEachInRadius(Origin, Radius, [&OutInteractives](ATEST_Interactive* Interactive, const FVector& Location)
+	{
+		OutInteractives.Add(Interactive);
+	});
+}
+
+bool UTEST_InteractiveRegistry::HasAnyInRadius(const FVector& Origin, float Radius) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_TESTInteractiveRegistryQuery);
+
+	return Grid.AnyInRadius(Origin, Radius);
+}
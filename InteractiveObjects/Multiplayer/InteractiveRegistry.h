@@ -0,0 +1,49 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "TESTSpatialGrid.h"
+#include "TEST_InteractiveRegistry.generated.h"
+
+class ATEST_Interactive;
+
+/**
+ * Keeps every interactive object in uniform grid so characters
+ * and AI can find interactive objects without physics traces
+ */
+UCLASS(config=Game)
+class TEST_API UTEST_InteractiveRegistry : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// Called by interactive objects on BeginPlay, EndPlay and after move
+	void Register(ATEST_Interactive* Interactive);
+	void Unregister(ATEST_Interactive* Interactive);
+	void UpdateLocation(ATEST_Interactive* Interactive);
+
+	// Nearest interactive object inside cone, null if none
+	UFUNCTION(BlueprintCallable, Category = "Interactive")
+	ATEST_Interactive* FindNearestInCone(FVector Origin, FVector Direction, float MaxDistance, float HalfAngleDegrees, AActor* IgnoreActor = nullptr) const;
+
+	// All interactive objects inside sphere
+	UFUNCTION(BlueprintCallable, Category = "Interactive")
+	void GetInteractivesInRadius(FVector Origin, float Radius, TArray<ATEST_Interactive*>& OutInteractives) const;
+
+	// Fast check if there is anything interactive inside sphere
+	bool HasAnyInRadius(const FVector& Origin, float Radius) const;
+
+	int32 Num() const { return Grid.Num(); }
+
+	// Size of one grid cell
+	UPROPERTY(config)
+	float CellSize = 1000.f;
+
+private:
+	TTESTSpatialGrid<ATEST_Interactive*> Grid;
+};
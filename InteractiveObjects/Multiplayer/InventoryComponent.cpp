@@ -0,0 +1,168 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TEST_InventoryComponent.h"
+#include "TEST_ItemCatalog.h"
+#include "TEST_Interactive.h"
+#include "Net/UnrealNetwork.h"
+
+DECLARE_DWORD_COUNTER_STAT(TEXT("Inventory slots changed"), STAT_TESTInventorySlotsChanged, STATGROUP_Game);
+
+void FTEST_InventorySlot::PostReplicatedAdd(const FTEST_InventoryList& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->NotifySlotChanged(SlotIndex);
+	}
+}
+
+void FTEST_InventorySlot::PostReplicatedChange(const FTEST_InventoryList& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->NotifySlotChanged(SlotIndex);
+	}
+}
+
+UTEST_InventoryComponent::UTEST_InventoryComponent()
+{
+	// Inventory changes only on requests, no tick needed
+	PrimaryComponentTick.bCanEverTick = false;
+	bReplicates = true;
+
+	ItemCatalog = nullptr;
+	Inventory.Owner = this;
+}
+
+void UTEST_InventoryComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// Only owner displays inventory on HUD
+	DOREPLIFETIME_CONDITION(UTEST_InventoryComponent, Inventory, COND_OwnerOnly);
+}
+
+void UTEST_InventoryComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (GetOwnerRole() == ROLE_Authority)
+	{
+		NumSlots = FMath::Clamp(NumSlots, 1, static_cast<int32>(MAX_uint8));
+		Inventory.Slots.SetNum(NumSlots);
+		for (int32 Index = 0; Index < NumSlots; ++Index)
+		{
+			Inventory.Slots[Index].SlotIndex = static_cast<uint8>(Index);
+			Inventory.MarkItemDirty(Inventory.Slots[Index]);
+		}
+	}
+}
+
+int32 UTEST_InventoryComponent::AddItem(uint8 ItemId, int32 Count)
+{
+	const int32 MaxStack = ItemCatalog ? ItemCatalog->GetMaxStack(ItemId) : 0;
+	if (GetOwnerRole() != ROLE_Authority || MaxStack == 0 || Count <= 0)
+	{
+		return FMath::Max(Count, 0);
+	}
+
+	// Fill existing stacks
+	for (FTEST_InventorySlot& Slot : Inventory.Slots)
+	{
+		if (Count == 0)
+		{
+			break;
+		}
+		if (!Slot.IsEmpty() && Slot.ItemId == ItemId && Slot.Count < MaxStack)
+		{
+			const int32 Added = FMath::Min(Count, MaxStack - Slot.Count);
+			Slot.Count = static_cast<uint16>(Slot.Count + Added);
+			Count -= Added;
+			MarkSlotDirty(Slot);
+		}
+	}
+
+	// Rest goes to empty slots
+	for (FTEST_InventorySlot& Slot : Inventory.Slots)
+	{
+		if (Count == 0)
+		{
+			break;
+		}
+		if (Slot.IsEmpty())
+		{
+			const int32 Added = FMath::Min(Count, MaxStack);
+			Slot.ItemId = ItemId;
+			Slot.Count = static_cast<uint16>(Added);
+			Count -= Added;
+			MarkSlotDirty(Slot);
+		}
+	}
+	return Count;
+}
+
+int32 UTEST_InventoryComponent::RemoveFromSlot(int32 SlotIndex, int32 Count)
+{
+	FTEST_InventorySlot* Slot = FindSlot(SlotIndex);
+	if (GetOwnerRole() != ROLE_Authority || Slot == nullptr || Slot->IsEmpty() || Count <= 0)
+	{
+		return 0;
+	}
+	const int32 Removed = FMath::Min(Count, static_cast<int32>(Slot->Count));
+	Slot->Count = static_cast<uint16>(Slot->Count - Removed);
+	if (Slot->IsEmpty())
+	{
+		Slot->ItemId = UTEST_ItemCatalog::InvalidItemId;
+	}
+	MarkSlotDirty(*Slot);
+	return Removed;
+}
+
+const FTEST_InventorySlot* UTEST_InventoryComponent::GetSlot(int32 SlotIndex) const
+{
+	return const_cast<UTEST_InventoryComponent*>(this)->FindSlot(SlotIndex);
+}
+
+int32 UTEST_InventoryComponent::GetSlotCount(int32 SlotIndex) const
+{
+	const FTEST_InventorySlot* Slot = GetSlot(SlotIndex);
+	return Slot ? Slot->Count : 0;
+}
+
+FText UTEST_InventoryComponent::GetSlotItemName(int32 SlotIndex) const
+{
+	const FTEST_InventorySlot* Slot = GetSlot(SlotIndex);
+	if (Slot == nullptr || Slot->IsEmpty() || ItemCatalog == nullptr)
+	{
+		return FText::GetEmpty();
+	}
+	return ItemCatalog->GetItemName(Slot->ItemId);
+}
+
+TSubclassOf<ATEST_Interactive> UTEST_InventoryComponent::GetSlotItemClass(int32 SlotIndex) const
+{
+	const FTEST_InventorySlot* Slot = GetSlot(SlotIndex);
+	if (Slot == nullptr || Slot->IsEmpty() || ItemCatalog == nullptr)
+	{
+		return nullptr;
+	}
+	return ItemCatalog->GetItemClass(Slot->ItemId);
+}
+
+FTEST_InventorySlot* UTEST_InventoryComponent::FindSlot(int32 SlotIndex)
+{
+	// Server keeps slots in order, client array may be reordered
+	if (Inventory.Slots.IsValidIndex(SlotIndex) && Inventory.Slots[SlotIndex].SlotIndex == SlotIndex)
+	{
+		return &Inventory.Slots[SlotIndex];
+	}
+	return Inventory.Slots.FindByPredicate([SlotIndex](const FTEST_InventorySlot& Slot) { return Slot.SlotIndex == SlotIndex; });
+}
+
+void UTEST_InventoryComponent::MarkSlotDirty(FTEST_InventorySlot& Slot)
+{
+	INC_DWORD_STAT(STAT_TESTInventorySlotsChanged);
+	Inventory.MarkItemDirty(Slot);
+	// Replication callbacks are not called on server
+	NotifySlotChanged(Slot.SlotIndex);
+}
@@ -0,0 +1,132 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Engine/NetSerialization.h"
+#include "TEST_InventoryComponent.generated.h"
+
+class UTEST_InventoryComponent;
+class UTEST_ItemCatalog;
+struct FTEST_InventoryList;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FTESTInventorySlotChanged, int32, SlotIndex);
+
+// One inventory slot, stack of items with the same catalog ID
+USTRUCT()
+struct FTEST_InventorySlot : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	// Client array order may differ from server, so slot keeps its index
+	UPROPERTY()
+	uint8 SlotIndex = 0;
+
+	// UTEST_ItemCatalog ID, InvalidItemId for empty slot
+	UPROPERTY()
+	uint8 ItemId = 0;
+
+	UPROPERTY()
+	uint16 Count = 0;
+
+	bool IsEmpty() const { return Count == 0; }
+
+	// Notify HUD on clients
+	void PostReplicatedAdd(const FTEST_InventoryList& InArraySerializer);
+	void PostReplicatedChange(const FTEST_InventoryList& InArraySerializer);
+};
+
+// Slots replicated by delta, only changed slots are sent
+USTRUCT()
+struct FTEST_InventoryList : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FTEST_InventorySlot> Slots;
+
+	// Component which is notified about replicated changes
+	UTEST_InventoryComponent* Owner = nullptr;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{
+		return FFastArraySerializer::FastArrayDeltaSerialize<FTEST_InventorySlot, FTEST_InventoryList>(Slots, DeltaParms, *this);
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FTEST_InventoryList> : public TStructOpsTypeTraitsBase2<FTEST_InventoryList>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
+
+/**
+ * Inventory with fixed number of slots holding stacks of items.
+ * Server changes it, owning client gets only changed slots
+ */
+UCLASS(ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
+class TEST_API UTEST_InventoryComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UTEST_InventoryComponent();
+
+	void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	// Add items to existing stacks first, then to empty slots.
+	// Server only, returns number of items which did not fit
+	int32 AddItem(uint8 ItemId, int32 Count = 1);
+
+	// Server only, returns number of removed items
+	int32 RemoveFromSlot(int32 SlotIndex, int32 Count = 1);
+
+	// Null for slot which is not created or not replicated yet
+	const FTEST_InventorySlot* GetSlot(int32 SlotIndex) const;
+
+	// To call in Blueprint and use on HUD
+	UFUNCTION(BlueprintPure, Category = "Inventory")
+	int32 GetSlotCount(int32 SlotIndex) const;
+
+	// To call in Blueprint and use on HUD, empty for empty slot
+	UFUNCTION(BlueprintPure, Category = "Inventory")
+	FText GetSlotItemName(int32 SlotIndex) const;
+
+	// Class to spawn after item is dropped from slot
+	TSubclassOf<class ATEST_Interactive> GetSlotItemClass(int32 SlotIndex) const;
+
+	int32 GetNumSlots() const { return NumSlots; }
+
+	// Called on server and owning client after slot changed
+	UPROPERTY(BlueprintAssignable, Category = "Inventory")
+	FTESTInventorySlotChanged OnSlotChanged;
+
+	// Items which can be stored, gives them compact IDs. Must be assigned in
+	// character Blueprint and list every pickup class, other items are refused
+	UPROPERTY(EditDefaultsOnly, Category = "Inventory")
+	UTEST_ItemCatalog* ItemCatalog;
+
+	UPROPERTY(EditDefaultsOnly, Category = "Inventory", meta = (ClampMin = "1", ClampMax = "255"))
+	int32 NumSlots = 40;
+
+protected:
+	// Server creates all slots
+	virtual void BeginPlay() override;
+
+private:
+	friend struct FTEST_InventorySlot;
+
+	FTEST_InventorySlot* FindSlot(int32 SlotIndex);
+
+	// Replicate slot and notify listen server HUD
+	void MarkSlotDirty(FTEST_InventorySlot& Slot);
+
+	void NotifySlotChanged(int32 SlotIndex) { OnSlotChanged.Broadcast(SlotIndex); }
+
+	UPROPERTY(Replicated)
+	FTEST_InventoryList Inventory;
+};
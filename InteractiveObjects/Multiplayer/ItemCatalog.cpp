@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "TEST_ItemCatalog.h"
+#include "TEST_Interactive.h"
+
+constexpr uint8 UTEST_ItemCatalog::InvalidItemId;
+
+uint8 UTEST_ItemCatalog::FindItemId(TSubclassOf<ATEST_Interactive> Item) const
+{
+	if (Item == nullptr)
+	{
+		return InvalidItemId;
+	}
+	// Catalog is short, linear search is enough
+	const int32 Index = Items.IndexOfByPredicate([Item](const FTEST_ItemDefinition& Definition) { return Definition.ItemClass == Item; });
+	return Index != INDEX_NONE && Index < MAX_uint8 ? static_cast<uint8>(Index + 1) : InvalidItemId;
+}
+
+TSubclassOf<ATEST_Interactive> UTEST_ItemCatalog::GetItemClass(uint8 ItemId) const
+{
+	const int32 Index = static_cast<int32>(ItemId) - 1;
+	return Items.IsValidIndex(Index) ? Items[Index].ItemClass : nullptr;
+}
+
+int32 UTEST_ItemCatalog::GetMaxStack(uint8 ItemId) const
+{
+	const int32 Index = static_cast<int32>(ItemId) - 1;
+	return Items.IsValidIndex(Index) ? FMath::Clamp(Items[Index].MaxStack, 1, static_cast<int32>(MAX_uint16)) : 0;
+}
+
+FText UTEST_ItemCatalog::GetItemName(uint8 ItemId) const
+{
+	TSubclassOf<ATEST_Interactive> Item = GetItemClass(ItemId);
+	if (Item == nullptr)
+	{
+		return FText::GetEmpty();
+	}
+	return FText::FromString(Item.GetDefaultObject()->Name);
+}
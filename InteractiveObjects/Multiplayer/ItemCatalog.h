@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "TEST_ItemCatalog.generated.h"
+
+class ATEST_Interactive;
+
+// Item which can be stored in inventory
+USTRUCT(BlueprintType)
+struct FTEST_ItemDefinition
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Inventory")
+	TSubclassOf<ATEST_Interactive> ItemClass;
+
+	// How many items fit in one inventory slot
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Inventory", meta = (ClampMin = "1", ClampMax = "65535"))
+	int32 MaxStack = 1;
+};
+
+/**
+ * List of items which can be stored in inventory. Position in list
+ * gives item compact ID, so replicated state sends one byte instead
+ * of class reference and name
+ */
+UCLASS(BlueprintType)
+class TEST_API UTEST_ItemCatalog : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	// ID of empty slot
+	static constexpr uint8 InvalidItemId = 0;
+
+	// Item IDs are index + 1, so only 255 items fit
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Inventory")
+	TArray<FTEST_ItemDefinition> Items;
+
+	// InvalidItemId if item is not in catalog
+	uint8 FindItemId(TSubclassOf<ATEST_Interactive> Item) const;
+
+	// Null for InvalidItemId and unknown IDs
+	TSubclassOf<ATEST_Interactive> GetItemClass(uint8 ItemId) const;
+
+	// 0 for unknown IDs
+	int32 GetMaxStack(uint8 ItemId) const;
+
+	// Name set on item default object, empty for unknown IDs
+	FText GetItemName(uint8 ItemId) const;
+};
@@ -3,6 +3,11 @@
 
 #include "TEST_Pickup.h"
 
+ATEST_Pickup::ATEST_Pickup()
+{
+	InteractionCapabilities |= ETESTInteractionCapability::Pickup;
+}
+
 void ATEST_Pickup::OnInteract()
 {
 	Destroy();
@@ -14,6 +14,9 @@ class TEST_API ATEST_Pickup : public ATEST_Interactive
 {
 	GENERATED_BODY()
 
+public:
+	ATEST_Pickup();
+
 private:
 	// Do actions on every client like destroy
 	// play sound or add particle
@@ -5,12 +5,16 @@
 #include "Animation/AnimInstance.h"
 #include "Camera/CameraComponent.h"
 #include "Components/CapsuleComponent.h"
+#include "Components/SphereComponent.h"
 #include "Components/InputComponent.h"
 #include "Components/StaticMeshComponent.h"
 #include "UObject/ConstructorHelpers.h"
 #include "GameFramework/InputSettings.h"
 #include "Net/UnrealNetwork.h"
 #include "Engine/Engine.h"
+#include "Engine/Player.h"
+#include "GameFramework/GameNetworkManager.h"
+#include "GameFramework/PlayerController.h"
 #include "TimerManager.h"
 #include "HeadMountedDisplayFunctionLibrary.h"
 #include "Kismet/GameplayStatics.h"
@@ -23,15 +27,38 @@
 #include "WidgetTree.h"
 #include "TEST_Pickup.h"
 #include "TEST_Interactive.h"
+#include "TEST_InteractionFocusComponent.h"
+#include "TEST_InventoryComponent.h"
+#include "TEST_ItemCatalog.h"
 #include "TESTGameMode.h"
 
 
 DEFINE_LOG_CATEGORY_STATIC(LogFPChar, Warning, All);
 
+#define LOCTEXT_NAMESPACE "TESTCharacter"
+
 //////////////////////////////////////////////////////////////////////////
 // Shooting character with ability to pickup objects and store some in inventory
 // Work online
 
+constexpr uint32 FTEST_PackedCharacterState::ValueBits;
+constexpr int32 FTEST_PackedCharacterState::MaxValue;
+
+bool FTEST_PackedCharacterState::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	uint32 PackedHealth = FMath::Min<uint32>(Health, MaxValue);
+	uint32 PackedAmmo = FMath::Min<uint32>(Ammo, MaxValue);
+	Ar.SerializeInt(PackedHealth, MaxValue + 1);
+	Ar.SerializeInt(PackedAmmo, MaxValue + 1);
+	if (Ar.IsLoading())
+	{
+		Health = static_cast<uint16>(PackedHealth);
+		Ammo = static_cast<uint16>(PackedAmmo);
+	}
+	bOutSuccess = !Ar.IsError();
+	return true;
+}
+
 
 ATESTCharacter::ATESTCharacter()
 {
@@ -76,18 +103,34 @@ ATESTCharacter::ATESTCharacter()
 	FP_MuzzleLocation = CreateDefaultSubobject<USceneComponent>(TEXT("MuzzleLocation"));
 	FP_MuzzleLocation->SetupAttachment(FP_Gun);
 	FP_MuzzleLocation->SetRelativeLocation(FVector(0.0f, 70.0f, 2.5f));
+
+	// Create focus component, it traces only on locally controlled character
+	InteractionFocus = CreateDefaultSubobject<UTEST_InteractionFocusComponent>(TEXT("InteractionFocus"));
+	InteractionFocus->OnFocusChanged.AddDynamic(this, &ATESTCharacter::OnFocusChanged);
+
+	// Proximity sphere is enabled together with focus
+	InteractionProximity = CreateDefaultSubobject<USphereComponent>(TEXT("InteractionProximity"));
+	InteractionProximity->SetupAttachment(FirstPersonCameraComponent);
+	InteractionProximity->InitSphereRadius(InteractionFocus->TraceDistance);
+	InteractionProximity->SetCollisionObjectType(ECC_WorldDynamic);
+	InteractionProximity->SetCollisionResponseToAllChannels(ECR_Overlap);
+	InteractionProximity->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	InteractionProximity->SetGenerateOverlapEvents(true);
+	InteractionProximity->SetCanEverAffectNavigation(false);
+	InteractionProximity->OnComponentBeginOverlap.AddDynamic(InteractionFocus, &UTEST_InteractionFocusComponent::OnProximityBeginOverlap);
+	InteractionProximity->OnComponentEndOverlap.AddDynamic(InteractionFocus, &UTEST_InteractionFocusComponent::OnProximityEndOverlap);
+
+	Inventory = CreateDefaultSubobject<UTEST_InventoryComponent>(TEXT("Inventory"));
+	Inventory->OnSlotChanged.AddDynamic(this, &ATESTCharacter::OnInventorySlotChanged);
 	
 	// Set start values for players
 	FireRate = 1.0f;
-	bIsFiringWeapon = false;
 
 	MaxHealth = 100;
-	CurrentHealth = 50;
-	CurrentAmmo = 10;
+	StartHealth = 50;
+	StartAmmo = 10;
 
-	bPickup = false;
-	BackPackItem = nullptr;
-	BackpackItemName = "Empty";
+	BackpackItemName = LOCTEXT("EmptyBackpack", "Empty");
 }
 
 // Replicates variables
@@ -95,9 +138,10 @@ void ATESTCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLi
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME(ATESTCharacter, MaxHealth);
-	DOREPLIFETIME(ATESTCharacter, CurrentHealth);
-	DOREPLIFETIME(ATESTCharacter, BackPackItem);
+	// Max health is constant for character lifetime
+	DOREPLIFETIME_CONDITION(ATESTCharacter, MaxHealth, COND_InitialOnly);
+	// Only owner displays health, ammo and backpack on HUD
+	DOREPLIFETIME_CONDITION(ATESTCharacter, State, COND_OwnerOnly);
 }
 
 void ATESTCharacter::BeginPlay()
@@ -105,10 +149,37 @@ void ATESTCharacter::BeginPlay()
 	// Call the base class  
 	Super::BeginPlay();
 
+	if (HasAuthority())
+	{
+		State.Health = static_cast<uint16>(FMath::Clamp(StartHealth, 0, FMath::Min(MaxHealth, FTEST_PackedCharacterState::MaxValue)));
+		State.Ammo = static_cast<uint16>(FMath::Clamp(StartAmmo, 0, FTEST_PackedCharacterState::MaxValue));
+	}
+
 	//Attach gun mesh component to Skeleton, doing it here because the skeleton is not yet created in the constructor
 	FP_Gun->AttachToComponent(Mesh1P, FAttachmentTransformRules(EAttachmentRule::SnapToTarget, true), TEXT("GripPoint"));
 }
 
+void ATESTCharacter::PawnClientRestart()
+{
+	Super::PawnClientRestart();
+
+	// Only owning player needs to know what he is pointing at
+	if (IsLocallyControlled())
+	{
+		InteractionFocus->SetViewComponent(FirstPersonCameraComponent);
+		InteractionFocus->SetFocusEnabled(true);
+		InteractionProximity->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
+	}
+}
+
+void ATESTCharacter::UnPossessed()
+{
+	Super::UnPossessed();
+
+	InteractionFocus->SetFocusEnabled(false);
+	InteractionProximity->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+}
+
 //////////////////////////////////////////////////////////////////////////
 // Input
 
@@ -138,12 +209,13 @@ void ATESTCharacter::SetupPlayerInputComponent(class UInputComponent* PlayerInpu
 // Blueprints Functions
 int ATESTCharacter::GetAmmo()
 {
-	return CurrentAmmo;
+	// Owning client does not count shots server did not see yet
+	return FMath::Max(State.Ammo - UnackedFireCommands.Num(), 0);
 }
 
 int ATESTCharacter::GetHealth()
 {
-	return CurrentHealth;
+	return State.Health;
 }
 
 int ATESTCharacter::GetMaxHealth()
@@ -151,158 +223,287 @@ int ATESTCharacter::GetMaxHealth()
 	return MaxHealth;
 }
 
-FString ATESTCharacter::GetInteractionMessage()
+FText ATESTCharacter::GetInteractionMessage() const
 {
 	return InteractionMessage;
 }
 
-FString ATESTCharacter::GetBackpackItemName()
+FText ATESTCharacter::GetBackpackItemName() const
 {
 	return BackpackItemName;
 }
-//
 
-void ATESTCharacter::Tick(float DeltaTime)
+void ATESTCharacter::SetInteractionMessage(const FText& NewMessage)
+{
+	if (NewMessage.IsEmpty() && InteractionMessage.IsEmpty())
+	{
+		return;
+	}
+	InteractionMessage = NewMessage;
+	OnInteractionMessageChanged.Broadcast(InteractionMessage);
+}
+
+void ATESTCharacter::SetBackpackItemName(const FText& NewName)
+{
+	if (NewName.IdenticalTo(BackpackItemName))
+	{
+		return;
+	}
+	BackpackItemName = NewName;
+	OnBackpackItemNameChanged.Broadcast(BackpackItemName);
+}
+
+void ATESTCharacter::SelectSlot(int32 SlotIndex)
 {
-	Super::Tick(DeltaTime);
-	// Get Camera Location and Forward Vector to cast ray
-	FHitResult Hit;
-	FVector Start = FirstPersonCameraComponent->GetComponentLocation();
+	SelectedSlot = FMath::Clamp(SlotIndex, 0, Inventory->GetNumSlots() - 1);
+	UpdateBackpackItemName();
+}
 
-	FVector ForwardVector = FirstPersonCameraComponent->GetForwardVector();
-	FVector UpVector = FirstPersonCameraComponent->GetUpVector();
-	// Forward Vector is multipled by lenght of ray
-	FVector End = ((ForwardVector * 250.f) + Start);
-	FCollisionQueryParams CollisionParams;
-	// Ignore owner
-	CollisionParams.AddIgnoredActor(this);
+void ATESTCharacter::UpdateBackpackItemName()
+{
+	const int32 Count = Inventory->GetSlotCount(SelectedSlot);
+	if (Count == 0)
+	{
+		SetBackpackItemName(LOCTEXT("EmptyBackpack", "Empty"));
+	}
+	else if (Count == 1)
+	{
+		SetBackpackItemName(Inventory->GetSlotItemName(SelectedSlot));
+	}
+	else
+	{
+		SetBackpackItemName(FText::Format(LOCTEXT("BackpackStack", "{0} x{1}"), Inventory->GetSlotItemName(SelectedSlot), Count));
+	}
+}
 
-	if (GetWorld()->LineTraceSingleByChannel(Hit, Start, End, ECC_Visibility, CollisionParams))
+void ATESTCharacter::OnInventorySlotChanged(int32 SlotIndex)
+{
+	if (SlotIndex == SelectedSlot)
 	{
-		// If ray block on object check if it is interactive object, then if
-		// it is pickable and do proper actions
-		if (Hit.GetActor()->GetClass()->IsChildOf(ATEST_Interactive::StaticClass()))
+		UpdateBackpackItemName();
+	}
+}
+//
+
+void ATESTCharacter::OnFocusChanged(AActor* FocusedActor)
+{
+	// If focused object is interactive check if it is
+	// pickable and do proper actions
+	ATEST_Interactive* Interactive = Cast<ATEST_Interactive>(FocusedActor);
+	if (Interactive != nullptr && Interactive->HasInteractionCapability(ETESTInteractionCapability::Interactable))
+	{
+		PointingItem = Interactive;
+		// Set item message to display, built once per focus change
+		SetInteractionMessage(FText::Format(LOCTEXT("InteractionPrompt", "Press F to {0}"), FText::FromString(PointingItem->message)));
+		if (Interactive->HasInteractionCapability(ETESTInteractionCapability::Pickup))
 		{
-			PointingItem = Cast<ATEST_Interactive>(Hit.GetActor());
-			// Set item message to display
-			InteractionMessage = FString(TEXT("Press F to ")) + PointingItem->message;
-			if (Hit.GetActor()->GetClass()->IsChildOf(ATEST_Pickup::StaticClass()))
-			{
-				// If it is Pickable set flag and pass Actor to ItemHolder
-				bPickup = true;
-				ItemHolder = Hit.GetActor()->GetClass();
-			}
+			// If it is Pickable set flag and pass Actor to ItemHolder
+			ItemHolder = FocusedActor->GetClass();
 		}
 		else
 		{
-			// If it isn't interactive object, clear all
-			// this prevents to store data if after pointing
-			// ray will be block by non interactive object
-			InteractionMessage = "";
-			PointingItem = NULL;
 			ItemHolder = nullptr;
-			bPickup = false;
 		}
 	}
 	else
 	{
-		// If it isn't object, clear all
+		// If it isn't interactive object, clear all
 		// this prevents to store data if after pointing
-		// ray will be block by anything
-		InteractionMessage = "";
+		// ray will be block by non interactive object
+		SetInteractionMessage(FText::GetEmpty());
 		PointingItem = NULL;
 		ItemHolder = nullptr;
-		bPickup = false;
 	}
-
 }
 
 void ATESTCharacter::StartFire()
 {
-	// Prevents too fast fire and if player have no ammo
-	if (!bIsFiringWeapon && CurrentAmmo != 0) {
-		bIsFiringWeapon = true;
-		UWorld* World = GetWorld();
-		// Set timer to next fire
-		World->GetTimerManager().SetTimer(FiringTimer, this, &ATESTCharacter::StopFire, FireRate, false);
-		OnFire();
-		CurrentAmmo--;
-		// try and play the sound if specified
-		if (FireSound != NULL)
+	// Prevents too fast fire, if player have no ammo or too many
+	// unacknowledged shots mean connection is lost
+	const float Now = GetWorld()->GetTimeSeconds();
+	if (Now - LastFireTime < FireRate || GetAmmo() == 0 || UnackedFireCommands.Num() >= MaxUnackedFireCommands)
+	{
+		return;
+	}
+	LastFireTime = Now;
+
+	FTEST_FireCommand Command;
+	Command.Sequence = NextFireSequence++;
+	Command.MuzzleLocation = FP_MuzzleLocation->GetComponentLocation();
+	Command.Direction = GetControlRotation().Vector();
+	if (HasAuthority())
+	{
+		// Listen server fires directly
+		OnFire(Command);
+	}
+	else
+	{
+		// Send shot with next batch, ammo on HUD counts it already
+		UnackedFireCommands.Add(Command);
+		bHasNewFireCommands = true;
+	}
+	// try and play the sound if specified
+	if (FireSound != NULL)
+	{
+		UGameplayStatics::PlaySoundAtLocation(this, FireSound, GetActorLocation());
+	}
+
+	// try and play a firing animation if specified
+	if (FireAnimation != NULL)
+	{
+		// Get the animation object for the arms mesh
+		UAnimInstance* AnimInstance = Mesh1P->GetAnimInstance();
+		if (AnimInstance != NULL)
 		{
-			UGameplayStatics::PlaySoundAtLocation(this, FireSound, GetActorLocation());
+			AnimInstance->Montage_Play(FireAnimation, 1.0f);
 		}
+	}
+}
 
-		// try and play a firing animation if specified
-		if (FireAnimation != NULL)
+void ATESTCharacter::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+	if (UnackedFireCommands.Num() > 0)
+	{
+		SendFireCommands();
+	}
+}
+
+void ATESTCharacter::SendFireCommands()
+{
+	// New shots wait for next send at movement rate, shots of frames in between share one RPC
+	const float Now = GetWorld()->GetTimeSeconds();
+	const float SinceLastBatch = Now - LastFireBatchTime;
+	if ((bHasNewFireCommands && SinceLastBatch >= GetFireBatchInterval()) || SinceLastBatch >= FireResendInterval)
+	{
+		ServerFireBatch(UnackedFireCommands);
+		bHasNewFireCommands = false;
+		LastFireBatchTime = Now;
+	}
+}
+
+float ATESTCharacter::GetFireBatchInterval() const
+{
+	// Same rate as character movement sends moves, slower on slow connections
+	const AGameNetworkManager* NetworkManager = GetDefault<AGameNetworkManager>();
+	const APlayerController* PlayerController = Cast<APlayerController>(GetController());
+	const UPlayer* Player = PlayerController != nullptr ? PlayerController->Player : nullptr;
+	if (Player != nullptr && Player->CurrentNetSpeed <= NetworkManager->ClientNetSendMoveThrottleAtNetSpeed)
+	{
+		return NetworkManager->ClientNetSendMoveDeltaTimeThrottled;
+	}
+	return NetworkManager->ClientNetSendMoveDeltaTime;
+}
+
+void ATESTCharacter::ServerFireBatch_Implementation(const TArray<FTEST_FireCommand>& Commands)
+{
+	// Client never has more unacknowledged shots, bigger batch is not from this game
+	if (Commands.Num() > MaxUnackedFireCommands)
+	{
+		UE_LOG(LogFPChar, Warning, TEXT("%s sent %d fire commands, limit is %d, batch rejected"), *GetName(), Commands.Num(), MaxUnackedFireCommands);
+		return;
+	}
+
+	const float ServerTime = GetWorld()->GetTimeSeconds();
+
+	// Resent commands are already processed, only newer ones fire
+	for (const FTEST_FireCommand& Command : Commands)
+	{
+		if (!IsNewerFireSequence(Command.Sequence, LastProcessedFireSequence))
 		{
-			// Get the animation object for the arms mesh
-			UAnimInstance* AnimInstance = Mesh1P->GetAnimInstance();
-			if (AnimInstance != NULL)
-			{
-				AnimInstance->Montage_Play(FireAnimation, 1.0f);
-			}
+			continue;
+		}
+		LastProcessedFireSequence = Command.Sequence;
+
+		// Server owns ammo and fire rate, rejected shot is corrected by replicated ammo
+		if (State.Ammo > 0 && ServerTime - LastFireTime >= FireRate - FireRateTolerance)
+		{
+			LastFireTime = ServerTime;
+			OnFire(Command);
 		}
 	}
+	ClientAckFire(LastProcessedFireSequence);
 }
 
-// Prevents too fast fire
-void ATESTCharacter::StopFire()
+void ATESTCharacter::ClientAckFire_Implementation(uint16 AckedSequence)
 {
-	bIsFiringWeapon = false;
+	UnackedFireCommands.RemoveAll([AckedSequence](const FTEST_FireCommand& Command)
+	{
+		return !IsNewerFireSequence(Command.Sequence, AckedSequence);
+	});
 }
 
 // Server fire function
-void ATESTCharacter::OnFire_Implementation()
+void ATESTCharacter::OnFire(const FTEST_FireCommand& Command)
 {
+	if (State.Ammo == 0)
+	{
+		return;
+	}
+	AddAmmo(-1);
+
 	// try and fire a projectile
 	if (ProjectileClass != NULL)
 	{
 		UWorld* const World = GetWorld();
 		if (World != NULL)
-		{	// Set spawn location, rotation and parameters to projectile fired by player
+		{	// Set spawn location, rotation and parameters to projectile fired by player.
+			// Shot goes from where client saw it, if it is close to server muzzle
 			FVector spawnLocation = FP_MuzzleLocation->GetComponentLocation();
-			FRotator spawnRotation = GetControlRotation();
+			if (FVector::DistSquared(Command.MuzzleLocation, spawnLocation) <= FMath::Square(MaxMuzzleError))
+			{
+				spawnLocation = Command.MuzzleLocation;
+			}
+			FRotator spawnRotation = Command.Direction.IsNearlyZero() ? GetControlRotation() : Command.Direction.Rotation();
 
 			FActorSpawnParameters spawnParameters;
 			spawnParameters.Instigator = Instigator;
 			spawnParameters.Owner = this;
-			FCollisionQueryParams CollisionParams;
 
 			// Spawn Projectile on all clients
-			ATESTProjectile* spawnedProjectile = GetWorld()->SpawnActor<ATESTProjectile>(spawnLocation, spawnRotation, spawnParameters);
+			ATESTProjectile* spawnedProjectile = World->SpawnActor<ATESTProjectile>(spawnLocation, spawnRotation, spawnParameters);
 		}
 	}
 }
 
 void ATESTCharacter::DropItem()
 {
-	// Drop item if is in "Backpack"
-	if (BackPackItem != nullptr)
+	// Drop item if is in selected slot, name is updated after replication
+	if (Inventory->GetSlotCount(SelectedSlot) > 0)
 	{
-		OnDropItem(BackPackItem);
-		BackpackItemName = "Empty";
+		OnDropItem(static_cast<uint8>(SelectedSlot));
 	}
 }
 
-// Pass item to server
-void ATESTCharacter::ServerTakeItem_Implementation(TSubclassOf<ATEST_Interactive> Item)
+// Server function to store item in inventory
+bool ATESTCharacter::TakeItem(TSubclassOf<ATEST_Interactive> Item)
 {
-	// If in Backpack is item drop it than take new
-	if (BackPackItem != nullptr)
+	// Item without catalog ID can not be stored, so interaction is refused
+	if (Inventory->ItemCatalog == nullptr)
 	{
-		OnDropItem(BackPackItem);
+		UE_LOG(LogFPChar, Warning, TEXT("%s has no ItemCatalog assigned, %s can not be picked up"), *GetName(), *GetNameSafe(Item));
+		return false;
 	}
-	BackPackItem = Item;
+	const uint8 ItemId = Inventory->ItemCatalog->FindItemId(Item);
+	if (ItemId == UTEST_ItemCatalog::InvalidItemId)
+	{
+		UE_LOG(LogFPChar, Warning, TEXT("%s is missing in item catalog %s"), *GetNameSafe(Item), *Inventory->ItemCatalog->GetName());
+		return false;
+	}
+	return Inventory->AddItem(ItemId) == 0;
 }
 
 // Server function to spawn item after drop
-void ATESTCharacter::OnDropItem_Implementation(TSubclassOf<ATEST_Interactive> Item)
+void ATESTCharacter::OnDropItem_Implementation(uint8 SlotIndex)
 {
+	TSubclassOf<ATEST_Interactive> Item = Inventory->GetSlotItemClass(SlotIndex);
+	if (Item == nullptr || Inventory->RemoveFromSlot(SlotIndex) == 0)
+	{
+		return;
+	}
 	FVector spawnLocation = FP_MuzzleLocation->GetComponentLocation();
 	FActorSpawnParameters spawnParameters;
 	ATEST_Pickup* spawnItem = GetWorld()->SpawnActor<ATEST_Pickup>(Item, spawnLocation, FRotator::ZeroRotator, spawnParameters);
-	BackPackItem = nullptr;
 }
 
 
@@ -327,13 +528,8 @@ void ATESTCharacter::MoveRight(float Value)
 
 void ATESTCharacter::Interaction()
 {
-	// Handle item interaction and set name and 
-	//pass it to server if is pickable
-	if (bPickup)
-	{
-		BackpackItemName = PointingItem->Name;
-		ServerTakeItem(ItemHolder);
-	}
+	// Server handle item interaction and
+	// put it in inventory if is pickable
 	ServerInteraction(PointingItem);
 }
 
@@ -350,15 +546,35 @@ void ATESTCharacter::ServerInteraction_Implementation(ATEST_Interactive* PItem)
 	PointingItem = PItem;
 	if (PointingItem && Role == ROLE_Authority)
 	{
+		// Pickup stays in world if it can not be stored
+		if (PointingItem->HasInteractionCapability(ETESTInteractionCapability::Pickup) && !TakeItem(PointingItem->GetClass()))
+		{
+			return;
+		}
 		PointingItem->InteractBy(this);
 	}
 }
 
 void ATESTCharacter::UpdateHealth(int HealthChange)
 {
-		// Increase or decrease current health
-		CurrentHealth += HealthChange;
-		// Prevents to overlap health values
-		if (CurrentHealth < 0) { CurrentHealth = 0; }
-		if (CurrentHealth > MaxHealth) { CurrentHealth = 100; }
-}
\ No newline at end of file
+	// Clients get health by replication
+	if (!HasAuthority())
+	{
+		return;
+	}
+	// Increase or decrease current health, prevents to overlap health values
+	const int MaxValue = FMath::Min(MaxHealth, FTEST_PackedCharacterState::MaxValue);
+	State.Health = static_cast<uint16>(FMath::Clamp(State.Health + HealthChange, 0, MaxValue));
+}
+
+void ATESTCharacter::AddAmmo(int AmmoChange)
+{
+	// Clients get ammunition by replication
+	if (!HasAuthority())
+	{
+		return;
+	}
+	State.Ammo = static_cast<uint16>(FMath::Clamp(State.Ammo + AmmoChange, 0, FTEST_PackedCharacterState::MaxValue));
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -9,6 +9,61 @@
 
 class UInputComponent;
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FTESTHudTextChanged, const FText&, Text);
+
+/**
+ * Health and ammo of character packed to 20 bits,
+ * replicated only to owning player
+ */
+USTRUCT()
+struct FTEST_PackedCharacterState
+{
+	GENERATED_BODY()
+
+	// Health and ammo are sent with this many bits
+	static constexpr uint32 ValueBits = 10;
+	static constexpr int32 MaxValue = (1 << ValueBits) - 1;
+
+	UPROPERTY()
+	uint16 Health = 0;
+
+	UPROPERTY()
+	uint16 Ammo = 0;
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+
+	bool operator==(const FTEST_PackedCharacterState& Other) const
+	{
+		return Health == Other.Health && Ammo == Other.Ammo;
+	}
+};
+
+template<>
+struct TStructOpsTypeTraits<FTEST_PackedCharacterState> : public TStructOpsTypeTraitsBase2<FTEST_PackedCharacterState>
+{
+	enum
+	{
+		WithNetSerializer = true,
+		WithIdenticalViaEquality = true,
+	};
+};
+
+// One shot fired by client, sent unreliably until server acknowledges it
+USTRUCT()
+struct FTEST_FireCommand
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	uint16 Sequence = 0;
+
+	UPROPERTY()
+	FVector_NetQuantize MuzzleLocation;
+
+	UPROPERTY()
+	FVector_NetQuantizeNormal Direction;
+};
+
 UCLASS(config=Game)
 class ATESTCharacter : public ACharacter
 {
@@ -33,10 +88,19 @@ class ATESTCharacter : public ACharacter
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
 	class UCameraComponent* FirstPersonCameraComponent;
 
+	/** Finds interactive object pointed by camera */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Interaction, meta = (AllowPrivateAccess = "true"))
+	class UTEST_InteractionFocusComponent* InteractionFocus;
+
+	/** Overlap around player to refresh focus when objects come close */
+	UPROPERTY(VisibleDefaultsOnly, Category = Interaction)
+	class USphereComponent* InteractionProximity;
+
+	/** Slots with picked up items, replicated only to owner */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Inventory, meta = (AllowPrivateAccess = "true"))
+	class UTEST_InventoryComponent* Inventory;
+
 public:
-	UPROPERTY(VisibleAnywhere)
-	FString InteractionMessage;
-	
 	ATESTCharacter();
 	
 	// Required network setup
@@ -61,6 +125,10 @@ public:
 	UPROPERTY(EditDefaultsOnly, Category=Projectile)
 	TSubclassOf<class ATESTProjectile> ProjectileClass;
 
+	// Largest accepted distance between muzzle sent by client and muzzle on server
+	UPROPERTY(EditDefaultsOnly, Category=Projectile)
+	float MaxMuzzleError = 100.f;
+
 	/** Sound to play each time we fire */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Gameplay)
 	class USoundBase* FireSound;
@@ -77,10 +145,6 @@ public:
 	UPROPERTY(BlueprintReadOnly)
 	TSubclassOf<ATEST_Interactive> ItemHolder;
 
-	// Variable to save item in "Backpack"
-	UPROPERTY(Replicated, EditAnywhere, BlueprintReadWrite)
-	TSubclassOf<ATEST_Interactive> BackPackItem;
-
 	// To call in Blueprint and use on HUD
 	UFUNCTION(BlueprintPure)
 	int GetAmmo();
@@ -93,44 +157,108 @@ public:
 	UFUNCTION(BlueprintPure)
 	int GetMaxHealth();
 
-	// To call in Blueprint and use on HUD
+	// To call in Blueprint and use on HUD, prefer OnInteractionMessageChanged
 	UFUNCTION(BlueprintPure)
-	FString GetInteractionMessage();
+	FText GetInteractionMessage() const;
 
-	// To call in Blueprint and use on HUD
+	// To call in Blueprint and use on HUD, prefer OnBackpackItemNameChanged
 	UFUNCTION(BlueprintPure)
-	FString GetBackpackItemName();
+	FText GetBackpackItemName() const;
+
+	// Choose inventory slot used by drop and shown as backpack item
+	UFUNCTION(BlueprintCallable, Category = Inventory)
+	void SelectSlot(int32 SlotIndex);
+
+	UFUNCTION(BlueprintPure, Category = Inventory)
+	int32 GetSelectedSlot() const { return SelectedSlot; }
+
+	// Cached prompt, rebuilt only when focused item changes
+	const FText& GetInteractionPrompt() const { return InteractionMessage; }
+
+	// HUD binds to these instead of polling getters every frame
+	UPROPERTY(BlueprintAssignable, Category = "HUD")
+	FTESTHudTextChanged OnInteractionMessageChanged;
 
-	// Save name of item in inventory
-	FString BackpackItemName;
+	UPROPERTY(BlueprintAssignable, Category = "HUD")
+	FTESTHudTextChanged OnBackpackItemNameChanged;
 
-	// Amount of character ammunition
-	int CurrentAmmo;
+	// Add or remove ammunition, server only
+	void AddAmmo(int AmmoChange);
 protected:
-	// Called on every Tick
-	virtual void Tick(float DeltaTime) override;
+	// Update pointing item after focus changed
+	UFUNCTION()
+	void OnFocusChanged(AActor* FocusedActor);
 
-	// Start fire on client to play sound and invoke 
-	// to server function after press fire
+	// Enable focus tracing only on locally controlled character
+	virtual void PawnClientRestart() override;
+	virtual void UnPossessed() override;
+
+	// Start fire on client to play sound and queue
+	// fire command for server after press fire
 	void StartFire();
-	
-	// Sets a flag that prohibits the player from shooting
-	void StopFire();
 
-	// Server spawn projectile after shoot
-	UFUNCTION(Server, Reliable)
-	void OnFire();
+	// Server spawn projectile after shoot and use ammunition
+	void OnFire(const FTEST_FireCommand& Command);
+
+	// Fire commands not acknowledged by server, resent with every batch.
+	// Unreliable so lost packets do not stall reliable buffer
+	UFUNCTION(Server, Unreliable)
+	void ServerFireBatch(const TArray<FTEST_FireCommand>& Commands);
+
+	// Last processed fire sequence, client drops acknowledged commands
+	UFUNCTION(Client, Unreliable)
+	void ClientAckFire(uint16 AckedSequence);
+
+	// Send unacknowledged fire commands, new ones with next batch, old ones
+	// again after FireResendInterval
+	void SendFireCommands();
+
+	// Time between batches of new fire commands
+	float GetFireBatchInterval() const;
+
+	// True if sequence A was issued after B, handles wrap around
+	static bool IsNewerFireSequence(uint16 A, uint16 B) { return static_cast<int16>(A - B) > 0; }
+
+	// Client only, shots waiting for acknowledge
+	TArray<FTEST_FireCommand> UnackedFireCommands;
 
-	// If item is in inventory drop in, Key E
+	uint16 NextFireSequence = 1;
+
+	bool bHasNewFireCommands = false;
+
+	float LastFireBatchTime = 0.f;
+
+	// Server only, last fire command processed
+	uint16 LastProcessedFireSequence = 0;
+
+	// Time of last shot, client limits input with it and server checks fire rate
+	float LastFireTime = -BIG_NUMBER;
+
+	// Unacknowledged shots above this are not fired
+	UPROPERTY(EditDefaultsOnly, Category=Projectile)
+	int32 MaxUnackedFireCommands = 16;
+
+	// Resend interval of unacknowledged fire commands
+	UPROPERTY(EditDefaultsOnly, Category=Projectile)
+	float FireResendInterval = 0.1f;
+
+	// Server accepts shot this much sooner than FireRate after previous one
+	UPROPERTY(EditDefaultsOnly, Category=Projectile)
+	float FireRateTolerance = 0.1f;
+
+	virtual void Tick(float DeltaSeconds) override;
+
+	// If item is in selected slot drop one, Key E
 	void DropItem();
 
-	// Pass item to server
-	UFUNCTION(Server, Reliable)
-	void ServerTakeItem(TSubclassOf<ATEST_Interactive> Item);
+	// Server put item to inventory, false if there is no space, no
+	// ItemCatalog is assigned or item is missing in it
+	bool TakeItem(TSubclassOf<ATEST_Interactive> Item);
 
-	// Server spawn new item after drop from "backpack"
+	// Server spawn new item after drop from inventory slot. One call per
+	// key press, reliable so dropped item is never lost like a shot can be
 	UFUNCTION(Server, Reliable)
-	void OnDropItem(TSubclassOf<ATEST_Interactive> Item);
+	void OnDropItem(uint8 SlotIndex);
 
 	/** Handles moving forward/backward */
 	void MoveForward(float Val);
@@ -142,32 +270,54 @@ protected:
 	// only to hadle key press
 	void Interaction();
 
-	// Get item and do proper interaction action
+	// Get item and do proper interaction action, reliable for same reason as OnDropItem
 	UFUNCTION(Reliable, Server)
 	void ServerInteraction(ATEST_Interactive* PItem);
 
 	// Set time to next fire
 	float FireRate;
 
-	// Flag that give posibility to shoot
-	bool bIsFiringWeapon;
-	FTimerHandle FiringTimer;
-
 	// If player take damage reduce his health
 	UFUNCTION(BlueprintCallable)
 	float TakeDamage(float DamageTaken, struct FDamageEvent const& DamageEvent, AController* EventInstigator, AActor* DamageCauser) override;
 
-	// Character starting and max health value 
+	// Character max health value, sent only once so changes
+	// after spawn are not seen by clients. Limited to 1023
 	UPROPERTY(Replicated, EditAnywhere, BlueprintReadWrite)
 	int MaxHealth = 100;
 
+	// Character starting values
+	UPROPERTY(EditDefaultsOnly, Category = Gameplay)
+	int StartHealth = 50;
+
+	UPROPERTY(EditDefaultsOnly, Category = Gameplay)
+	int StartAmmo = 10;
+
 private:
-	// Flage to define object as pickable
-	bool bPickup;
-	
-	// Character current health
+	// Message to display for pointing item
+	UPROPERTY(VisibleAnywhere)
+	FText InteractionMessage;
+
+	// Save name of item in selected slot
+	FText BackpackItemName;
+
+	// Inventory slot shown on HUD and dropped, chosen by owning player
+	int32 SelectedSlot = 0;
+
+	// Set texts and notify HUD if they changed
+	void SetInteractionMessage(const FText& NewMessage);
+	void SetBackpackItemName(const FText& NewName);
+
+	// Name of item in selected slot
+	void UpdateBackpackItemName();
+
+	// Refresh name when selected slot changed on server or after replication
+	UFUNCTION()
+	void OnInventorySlotChanged(int32 SlotIndex);
+
+	// Character current health and ammunition
 	UPROPERTY(Replicated, VisibleAnywhere)
-	int CurrentHealth = 50;
+	FTEST_PackedCharacterState State;
 
 protected:
 	// APawn interface
@@ -178,6 +328,10 @@ public:
 	FORCEINLINE class USkeletalMeshComponent* GetMesh1P() const { return Mesh1P; }
 	/** Returns FirstPersonCameraComponent subobject **/
 	FORCEINLINE class UCameraComponent* GetFirstPersonCameraComponent() const { return FirstPersonCameraComponent; }
+	/** Returns Inventory subobject **/
+	FORCEINLINE class UTEST_InventoryComponent* GetInventory() const { return Inventory; }
+	/** Returns InteractionFocus subobject **/
+	FORCEINLINE class UTEST_InteractionFocusComponent* GetInteractionFocus() const { return InteractionFocus; }
 	
 	// Update player health level
 	// HealtgChange this is the amout to change health by, can be + or -
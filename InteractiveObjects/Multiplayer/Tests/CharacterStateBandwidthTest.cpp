@@ -0,0 +1,126 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "TESTAutomationWorld.h"
+#include "TESTNetTestSession.h"
+#include "TESTNetBandwidth.h"
+#include "TESTCharacter.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace TESTCharacterStateBandwidthTest
+{
+	const float DeltaTime = 1.f / 60.f;
+
+	FTEST_PackedCharacterState MakeState(uint16 Health, uint16 Ammo)
+	{
+		FTEST_PackedCharacterState State;
+		State.Health = Health;
+		State.Ammo = Ammo;
+		return State;
+	}
+
+	// Character of every client standing still next to others, so all are relevant to all
+	TArray<ATESTCharacter*> SpawnPossessedCharacters(UWorld* World, FTEST_NetTestSession& Session)
+	{
+		TArray<ATESTCharacter*> Characters;
+		for (int32 Client = 0; Client < Session.NumClients(); ++Client)
+		{
+			const FVector Location((Client % 8) * 200.f, (Client / 8) * 200.f, 0.f);
+			ATESTCharacter* Character = World->SpawnActor<ATESTCharacter>(Location, FRotator::ZeroRotator);
+			Character->GetCharacterMovement()->DisableMovement();
+			Session.GetPlayerController(Client)->Possess(Character);
+			Session.SetViewLocation(Client, Location);
+			Characters.Add(Character);
+		}
+		return Characters;
+	}
+
+	// Shot and hit or pickup, health and ammo change and return
+	void ChangeState(ATESTCharacter* Character, int32 Frame)
+	{
+		const int32 Change = Frame % 2 == 0 ? -1 : 1;
+		Character->UpdateHealth(Change);
+		Character->AddAmmo(Change);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTESTCharacterStatePackingTest, "TEST.Character.StatePacking", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTESTCharacterStatePackingTest::RunTest(const FString& Parameters)
+{
+	using namespace TESTCharacterStateBandwidthTest;
+
+	FTEST_PackedCharacterState Received;
+	TestEqual(TEXT("Packed state bits"), TESTNetBandwidth::RoundTrip(MakeState(50, 10), Received), static_cast<int64>(2 * FTEST_PackedCharacterState::ValueBits));
+	TestTrue(TEXT("State survives packing"), Received == MakeState(50, 10));
+	TESTNetBandwidth::RoundTrip(MakeState(2000, 5000), Received);
+	TestTrue(TEXT("Values above range are clamped"), Received == MakeState(FTEST_PackedCharacterState::MaxValue, FTEST_PackedCharacterState::MaxValue));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTESTCharacterStateBandwidthBenchmark, "TEST.Character.StateBandwidth", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FTESTCharacterStateBandwidthBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace TESTCharacterStateBandwidthTest;
+	using namespace TESTNetBandwidth;
+
+	const int32 NumClients = 64;
+	const int32 WarmupFrames = 30;
+	const int32 NumFrames = 60;
+
+	FTEST_AutomationWorld World;
+	FTEST_NetTestSession Session(World.Get(), NumClients);
+	if (!TestTrue(TEXT("Server listens with simulated clients"), Session.IsListening()))
+	{
+		return false;
+	}
+	TArray<ATESTCharacter*> Characters = SpawnPossessedCharacters(World.Get(), Session);
+	for (int32 Frame = 0; Frame < WarmupFrames; ++Frame)
+	{
+		World.Tick(DeltaTime);
+		Session.Tick(DeltaTime);
+	}
+
+	// Same number of frames for every run, so packet headers and keep alives cancel out
+	const TArray<int64> IdleBytes = MeasureClientBytes(World, Session, NumFrames, DeltaTime, [](int32 Frame) {});
+	const TArray<int64> OneChangingBytes = MeasureClientBytes(World, Session, NumFrames, DeltaTime, [&Characters](int32 Frame)
+	{
+		ChangeState(Characters[0], Frame);
+	});
+	const TArray<int64> AllChangingBytes = MeasureClientBytes(World, Session, NumFrames, DeltaTime, [&Characters](int32 Frame)
+	{
+		for (ATESTCharacter* Character : Characters)
+		{
+			ChangeState(Character, Frame);
+		}
+	});
+
+	// Owner of changing character gets its state, others get nothing more
+	const int64 OwnerBytes = GetExtraBytes(OneChangingBytes, IdleBytes, 0);
+	int64 OtherBytes = 0;
+	int64 AllBytes = 0;
+	for (int32 Client = 0; Client < NumClients; ++Client)
+	{
+		OtherBytes += Client > 0 ? GetExtraBytes(OneChangingBytes, IdleBytes, Client) : 0;
+		AllBytes += GetExtraBytes(AllChangingBytes, IdleBytes, Client);
+	}
+	const double OtherBytesPerClient = static_cast<double>(OtherBytes) / (NumClients - 1);
+	const double AllBytesPerClient = static_cast<double>(AllBytes) / NumClients;
+
+	TestTrue(TEXT("Owner gets state changes"), OwnerBytes > 0);
+	TestTrue(TEXT("Other clients do not get state of character they do not own"), OtherBytesPerClient < OwnerBytes);
+	// Replicated to everyone, every client would get changes of all characters
+	TestTrue(TEXT("Client traffic does not grow with number of changing characters"), AllBytesPerClient < OwnerBytes * 2.0);
+
+	const float Seconds = NumFrames * DeltaTime;
+	AddInfo(FString::Printf(TEXT("%d clients, health and ammo change every frame, bytes/s over idle: owner of one changing character %.0f, other clients %.1f, every client with all %d changing %.0f"),
+		NumClients, OwnerBytes / Seconds, OtherBytesPerClient / Seconds, NumClients, AllBytesPerClient / Seconds));
+	return true;
+}
+
+#endif
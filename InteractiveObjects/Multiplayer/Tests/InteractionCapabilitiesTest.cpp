@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "GameFramework/Pawn.h"
+#include "TEST_InteractionCapabilities.h"
+#include "TEST_Interactive.h"
+#include "TEST_Pickup.h"
+#include "TEST_AddAmmo.h"
+#include "TEST_AddHealth.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTESTInteractionCapabilitiesTest, "TEST.Interaction.Capabilities", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTESTInteractionCapabilitiesTest::RunTest(const FString& Parameters)
+{
+	using ECapability = ETESTInteractionCapability;
+
+	TestEqual(TEXT("Null actor"), ATEST_CapabilityActor::GetCapabilities(nullptr), ECapability::None);
+	TestEqual(TEXT("Plain actor"), ATEST_CapabilityActor::GetCapabilities(GetDefault<AActor>()), ECapability::None);
+	TestEqual(TEXT("Pawn"), ATEST_CapabilityActor::GetCapabilities(GetDefault<APawn>()), ECapability::None);
+
+	// Subclasses keep flags of their parents
+	TestEqual(TEXT("Pickup"), ATEST_CapabilityActor::GetCapabilities(GetDefault<ATEST_Pickup>()), ECapability::Interactable | ECapability::Pickup);
+	TestEqual(TEXT("Add ammo"), ATEST_CapabilityActor::GetCapabilities(GetDefault<ATEST_AddAmmo>()), ECapability::Interactable | ECapability::Consumable);
+	TestEqual(TEXT("Add health"), ATEST_CapabilityActor::GetCapabilities(GetDefault<ATEST_AddHealth>()), ECapability::Interactable | ECapability::Consumable);
+
+	// Flags agree with class hierarchy they replace
+	TestTrue(TEXT("Pickup flag only on pickups"), GetDefault<ATEST_Pickup>()->HasInteractionCapability(ECapability::Pickup) && !GetDefault<ATEST_AddAmmo>()->HasInteractionCapability(ECapability::Pickup));
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTESTInteractionCapabilitiesBenchmark, "TEST.Interaction.Capabilities.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FTESTInteractionCapabilitiesBenchmark::RunTest(const FString& Parameters)
+{
+	// Mix of actors focus trace can hit
+	const TArray<const AActor*> Actors = {
+		GetDefault<AActor>(), GetDefault<APawn>(), GetDefault<ATEST_Pickup>(), GetDefault<ATEST_AddAmmo>(), GetDefault<ATEST_AddHealth>() };
+	const int32 NumIterations = 2000000;
+
+	// Previous focus path: two class hierarchy checks
+	int32 HierarchyPickups = 0;
+	double StartTime = FPlatformTime::Seconds();
+	for (int32 Index = 0; Index < NumIterations; ++Index)
+	{
+		const UClass* Class = Actors[Index % Actors.Num()]->GetClass();
+		if (Class->IsChildOf(ATEST_Interactive::StaticClass()) && Class->IsChildOf(ATEST_Pickup::StaticClass()))
+		{
+			++HierarchyPickups;
+		}
+	}
+	const double HierarchyTime = FPlatformTime::Seconds() - StartTime;
+
+	// Current focus path: one cast and bit tests
+	int32 CapabilityPickups = 0;
+	StartTime = FPlatformTime::Seconds();
+	for (int32 Index = 0; Index < NumIterations; ++Index)
+	{
+		const ETESTInteractionCapability Capabilities = ATEST_CapabilityActor::GetCapabilities(Actors[Index % Actors.Num()]);
+		if (EnumHasAllFlags(Capabilities, ETESTInteractionCapability::Interactable | ETESTInteractionCapability::Pickup))
+		{
+			++CapabilityPickups;
+		}
+	}
+	const double CapabilityTime = FPlatformTime::Seconds() - StartTime;
+
+	TestEqual(TEXT("Both paths find same pickups"), CapabilityPickups, HierarchyPickups);
+	AddInfo(FString::Printf(TEXT("%d checks: class hierarchy %.2f ns, capability mask %.2f ns per check"),
+		NumIterations, HierarchyTime * 1.0e9 / NumIterations, CapabilityTime * 1.0e9 / NumIterations));
+	return true;
+}
+
+#endif
@@ -0,0 +1,261 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/MemoryBase.h"
+#include "HAL/PlatformTime.h"
+#include "Camera/CameraComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "TESTAutomationWorld.h"
+#include "TESTCharacter.h"
+#include "TEST_InteractionFocusComponent.h"
+#include "TEST_Pickup.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace TESTInteractionFocusTest
+{
+	const float DeltaTime = 1.f / 60.f;
+
+	// Pickup with collision traces can hit, standing still
+	ATEST_Pickup* SpawnPickup(UWorld* World, const FVector& Location)
+	{
+		UStaticMesh* Cube = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Cube.Cube"));
+		ATEST_Pickup* Pickup = World->SpawnActor<ATEST_Pickup>(Location, FRotator::ZeroRotator);
+		if (Pickup != nullptr && Cube != nullptr)
+		{
+			Pickup->ObjMesh->SetSimulatePhysics(false);
+			Pickup->ObjMesh->SetStaticMesh(Cube);
+		}
+		return Pickup;
+	}
+
+	// Character tracing focus as if it was locally controlled, without falling
+	ATESTCharacter* SpawnFocusingCharacter(UWorld* World, const FVector& Location)
+	{
+		ATESTCharacter* Character = World->SpawnActor<ATESTCharacter>(Location, FRotator::ZeroRotator);
+		if (Character != nullptr)
+		{
+			Character->GetCharacterMovement()->DisableMovement();
+			Character->GetInteractionFocus()->SetViewComponent(Character->GetFirstPersonCameraComponent());
+			Character->GetInteractionFocus()->SetFocusEnabled(true);
+		}
+		return Character;
+	}
+
+	// Set value of console variable and restore previous one when leaving scope
+	struct FScopedCVarValue
+	{
+		FScopedCVarValue(const TCHAR* Name, int32 Value)
+			: CVar(IConsoleManager::Get().FindConsoleVariable(Name))
+			, PreviousValue(CVar != nullptr ? CVar->GetInt() : 0)
+		{
+			if (CVar != nullptr)
+			{
+				CVar->Set(Value, ECVF_SetByCode);
+			}
+		}
+
+		~FScopedCVarValue()
+		{
+			if (CVar != nullptr)
+			{
+				CVar->Set(PreviousValue, ECVF_SetByCode);
+			}
+		}
+
+		IConsoleVariable* CVar;
+		int32 PreviousValue;
+	};
+
+	// Forwards to engine allocator, counting allocations made by game thread
+	class FTESTCountingMalloc : public FMalloc
+	{
+	public:
+		FMalloc* Inner = nullptr;
+		TAtomic<int32> NumAllocations{ 0 };
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			CountAllocation();
+			return Inner->Malloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			CountAllocation();
+			return Inner->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override { Inner->Free(Original); }
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+		virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+		virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override { Inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+		virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+		virtual bool ValidateHeap() override { return Inner->ValidateHeap(); }
+		virtual const TCHAR* GetDescriptiveName() override { return TEXT("TESTCountingMalloc"); }
+
+	private:
+		void CountAllocation()
+		{
+			if (IsInGameThread())
+			{
+				++NumAllocations;
+			}
+		}
+	};
+
+	// Count game thread allocations while in scope, allocator outlives scope
+	// because other threads may still be inside it after GMalloc is restored
+	struct FScopedMallocCounter
+	{
+		FScopedMallocCounter()
+		{
+			static FTESTCountingMalloc CountingMalloc;
+			Malloc = &CountingMalloc;
+			Malloc->Inner = GMalloc;
+			Malloc->NumAllocations = 0;
+			GMalloc = Malloc;
+		}
+
+		~FScopedMallocCounter()
+		{
+			GMalloc = Malloc->Inner;
+		}
+
+		int32 GetNumAllocations() const { return Malloc->NumAllocations; }
+
+		FTESTCountingMalloc* Malloc;
+	};
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTESTInteractionPromptAllocationTest, "TEST.Interaction.Prompt.Allocations", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::EngineFilter)
+
+bool FTESTInteractionPromptAllocationTest::RunTest(const FString& Parameters)
+{
+	using namespace TESTInteractionFocusTest;
+
+	const int32 NumFrames = 120;
+	FScopedCVarValue AsyncTrace(TEXT("TEST.Interaction.AsyncTrace"), 0);
+	FTEST_AutomationWorld World;
+	ATESTCharacter* Character = SpawnFocusingCharacter(World.Get(), FVector::ZeroVector);
+	ATEST_Pickup* Pickup = SpawnPickup(World.Get(), FVector(150.f, 0.f, 60.f));
+	if (!TestNotNull(TEXT("Character"), Character) || !TestNotNull(TEXT("Pickup"), Pickup))
+	{
+		return false;
+	}
+	UTEST_InteractionFocusComponent* Focus = Character->GetInteractionFocus();
+	// Periodic retrace is a physics query, not part of prompt cost
+	Focus->MaxTraceInterval = 0.f;
+	World.Tick(DeltaTime, 2);
+	if (!TestTrue(TEXT("Pickup is focused"), Focus->GetFocusedActor() == Pickup) || !TestFalse(TEXT("Prompt is built"), Character->GetInteractionPrompt().IsEmpty()))
+	{
+		return false;
+	}
+
+	// Counter must see allocations, otherwise zero below proves nothing
+	int32 NumAllocations = 0;
+	{
+		FScopedMallocCounter Counter;
+		const FText Prompt = FText::Format(FText::FromString(TEXT("Press F to {0}")), FText::FromString(Pickup->message));
+		NumAllocations = Counter.GetNumAllocations();
+	}
+	TestTrue(TEXT("Counter sees prompt allocations"), NumAllocations > 0);
+
+	// Focus component tick and HUD reading prompt, as on every frame with stable focus
+	int32 PromptLength = 0;
+	{
+		FScopedMallocCounter Counter;
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			Focus->TickComponent(DeltaTime, LEVELTICK_All, &Focus->PrimaryComponentTick);
+			PromptLength += Character->GetInteractionPrompt().ToString().Len();
+			PromptLength += Character->GetInteractionMessage().ToString().Len();
+		}
+		NumAllocations = Counter.GetNumAllocations();
+	}
+
+	TestTrue(TEXT("Prompt was read"), PromptLength > 0);
+	TestEqual(TEXT("Allocations with stable focus"), NumAllocations, 0);
+	return true;
+}
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FTESTInteractionFocusBenchmark, "TEST.Interaction.Focus.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+void FTESTInteractionFocusBenchmark::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	for (const int32 NumCharacters : { 32, 64, 128 })
+	{
+		OutBeautifiedNames.Add(FString::Printf(TEXT("%d"), NumCharacters));
+		OutTestCommands.Add(FString::FromInt(NumCharacters));
+	}
+}
+
+bool FTESTInteractionFocusBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace TESTInteractionFocusTest;
+
+	const int32 NumCharacters = FCString::Atoi(*Parameters);
+	const int32 NumFrames = 300;
+
+	for (const int32 bAsync : { 0, 1 })
+	{
+		FScopedCVarValue AsyncTrace(TEXT("TEST.Interaction.AsyncTrace"), bAsync);
+		if (!TestNotNull(TEXT("AsyncTrace console variable"), AsyncTrace.CVar))
+		{
+			return false;
+		}
+
+		// Every character looks around in front of its own pickup
+		FTEST_AutomationWorld World;
+		TArray<ATESTCharacter*> Characters;
+		for (int32 Index = 0; Index < NumCharacters; ++Index)
+		{
+			const FVector Location((Index % 16) * 500.f, (Index / 16) * 500.f, 0.f);
+			ATESTCharacter* Character = SpawnFocusingCharacter(World.Get(), Location);
+			if (!TestNotNull(TEXT("Character"), Character) || !TestNotNull(TEXT("Pickup"), SpawnPickup(World.Get(), Location + FVector(150.f, 0.f, 60.f))))
+			{
+				return false;
+			}
+			Character->GetInteractionFocus()->MaxTraceInterval = 0.f;
+			Characters.Add(Character);
+		}
+		World.Tick(DeltaTime);
+
+		// Turn more than AngleThreshold every frame, so every idle component traces
+		double TotalTime = 0.0;
+		double WorstTime = 0.0;
+		int32 NumFocused = 0;
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			const float Yaw = 30.f * FMath::Sin(Frame * 0.1f);
+			for (ATESTCharacter* Character : Characters)
+			{
+				Character->SetActorRotation(FRotator(0.f, Yaw, 0.f));
+			}
+			const double StartTime = FPlatformTime::Seconds();
+			World.Tick(DeltaTime);
+			const double FrameTime = FPlatformTime::Seconds() - StartTime;
+			TotalTime += FrameTime;
+			WorstTime = FMath::Max(WorstTime, FrameTime);
+
+			for (const ATESTCharacter* Character : Characters)
+			{
+				NumFocused += Character->GetInteractionPrompt().IsEmpty() ? 0 : 1;
+			}
+		}
+
+		TestTrue(TEXT("Characters focus pickups"), NumFocused > 0);
+		AddInfo(FString::Printf(TEXT("%d characters, %s traces: %.3f ms per frame, worst %.3f ms, %.1f focused per frame"),
+			NumCharacters, bAsync ? TEXT("async") : TEXT("sync"), TotalTime * 1000.0 / NumFrames, WorstTime * 1000.0, static_cast<double>(NumFocused) / NumFrames));
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,98 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "TESTAutomationWorld.h"
+#include "TESTNetTestSession.h"
+#include "TEST_Pickup.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace TESTInteractiveReplicationTest
+{
+	const float DeltaTime = 1.f / 30.f;
+	const float MapExtent = 50000.f;
+
+	// Replication settings every actor had before pickups got own policy
+	void UseDefaultReplication(AActor* Actor)
+	{
+		const AActor* Defaults = GetDefault<AActor>();
+		Actor->SetNetDormancy(DORM_Awake);
+		Actor->NetUpdateFrequency = Defaults->NetUpdateFrequency;
+		Actor->MinNetUpdateFrequency = Defaults->MinNetUpdateFrequency;
+		Actor->NetCullDistanceSquared = Defaults->NetCullDistanceSquared;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTESTInteractiveReplicationBenchmark, "TEST.Interaction.Replication.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FTESTInteractiveReplicationBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace TESTInteractiveReplicationTest;
+
+	const int32 NumPickups = 5000;
+	const int32 NumClients = 32;
+	const int32 WarmupFrames = 30;
+	const int32 NumFrames = 300;
+
+	for (const bool bDormant : { false, true })
+	{
+		FTEST_AutomationWorld World;
+		FTEST_NetTestSession Session(World.Get(), NumClients);
+		if (!TestTrue(TEXT("Server listens with simulated clients"), Session.IsListening()))
+		{
+			return false;
+		}
+
+		// Pickups scattered over large map, clients standing between them
+		FRandomStream Random(17);
+		TArray<ATEST_Pickup*> Pickups;
+		for (int32 Index = 0; Index < NumPickups; ++Index)
+		{
+			const FVector Location(Random.FRandRange(-MapExtent, MapExtent), Random.FRandRange(-MapExtent, MapExtent), 0.f);
+			ATEST_Pickup* Pickup = World->SpawnActor<ATEST_Pickup>(Location, FRotator::ZeroRotator);
+			if (!bDormant)
+			{
+				UseDefaultReplication(Pickup);
+			}
+			Pickups.Add(Pickup);
+		}
+		for (int32 Client = 0; Client < NumClients; ++Client)
+		{
+			Session.SetViewLocation(Client, FVector(Random.FRandRange(-MapExtent, MapExtent), Random.FRandRange(-MapExtent, MapExtent), 0.f));
+		}
+
+		// Initial replication is same for both, only idle map is measured
+		for (int32 Frame = 0; Frame < WarmupFrames; ++Frame)
+		{
+			World.Tick(DeltaTime);
+			Session.Tick(DeltaTime);
+		}
+
+		// Players take a pickup now and then
+		const int64 StartBytes = Session.GetOutBytes();
+		double NetTime = 0.0;
+		double WorstNetTime = 0.0;
+		int32 NumTaken = 0;
+		for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+		{
+			if (Frame % 10 == 0)
+			{
+				Pickups[NumTaken++]->InteractBy(nullptr);
+			}
+			World.Tick(DeltaTime);
+			const double FrameNetTime = Session.Tick(DeltaTime);
+			NetTime += FrameNetTime;
+			WorstNetTime = FMath::Max(WorstNetTime, FrameNetTime);
+		}
+		const double BytesPerSecond = (Session.GetOutBytes() - StartBytes) / (NumFrames * DeltaTime);
+
+		AddInfo(FString::Printf(TEXT("%d pickups, %d clients, %s: server net tick %.3f ms per frame (worst %.3f ms), %.0f bytes/s to all clients, %.0f bytes/s per client"),
+			NumPickups, NumClients, bDormant ? TEXT("dormant policy") : TEXT("default replication"),
+			NetTime * 1000.0 / NumFrames, WorstNetTime * 1000.0, BytesPerSecond, BytesPerSecond / NumClients));
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,126 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "CoreMinimal.h"
+#include "Misc/AutomationTest.h"
+#include "HAL/PlatformTime.h"
+#include "TESTAutomationWorld.h"
+#include "TEST_InventoryComponent.h"
+#include "TEST_ItemCatalog.h"
+#include "TEST_Pickup.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace TESTInventoryChurnTest
+{
+	// Catalog of items with different stack sizes, only stacks matter here
+	UTEST_ItemCatalog* MakeCatalog()
+	{
+		UTEST_ItemCatalog* Catalog = NewObject<UTEST_ItemCatalog>();
+		for (const int32 MaxStack : { 1, 5, 20, 99 })
+		{
+			FTEST_ItemDefinition& Definition = Catalog->Items.AddDefaulted_GetRef();
+			Definition.ItemClass = ATEST_Pickup::StaticClass();
+			Definition.MaxStack = MaxStack;
+		}
+		return Catalog;
+	}
+
+	// Server inventory on plain actor, component BeginPlay creates slots
+	UTEST_InventoryComponent* SpawnInventory(UWorld* World, UTEST_ItemCatalog* Catalog, int32 NumSlots)
+	{
+		AActor* Owner = World->SpawnActor<AActor>();
+		UTEST_InventoryComponent* Inventory = NewObject<UTEST_InventoryComponent>(Owner);
+		Inventory->ItemCatalog = Catalog;
+		Inventory->NumSlots = NumSlots;
+		Inventory->RegisterComponent();
+		return Inventory;
+	}
+
+	// Slots changed since last call, found by replication keys the fast array sends by
+	int32 CountDirtySlots(const UTEST_InventoryComponent* Inventory, TArray<int32>& InOutKeys)
+	{
+		int32 NumDirty = 0;
+		for (int32 SlotIndex = 0; SlotIndex < Inventory->GetNumSlots(); ++SlotIndex)
+		{
+			const int32 Key = Inventory->GetSlot(SlotIndex)->ReplicationKey;
+			if (InOutKeys[SlotIndex] != Key)
+			{
+				InOutKeys[SlotIndex] = Key;
+				++NumDirty;
+			}
+		}
+		return NumDirty;
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FTESTInventoryChurnBenchmark, "TEST.Inventory.Churn.Benchmark", EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::PerfFilter)
+
+bool FTESTInventoryChurnBenchmark::RunTest(const FString& Parameters)
+{
+	using namespace TESTInventoryChurnTest;
+
+	const int32 NumPlayers = 64;
+	const int32 NumSlots = 40;
+	const int32 NumFrames = 300;
+	const int32 ChangesPerFrame = 2;
+	FRandomStream Random(11);
+
+	FTEST_AutomationWorld World;
+	UTEST_ItemCatalog* Catalog = MakeCatalog();
+	TArray<UTEST_InventoryComponent*> Inventories;
+	TArray<TArray<int32>> Keys;
+	for (int32 Player = 0; Player < NumPlayers; ++Player)
+	{
+		UTEST_InventoryComponent* Inventory = SpawnInventory(World.Get(), Catalog, NumSlots);
+		if (!TestNotNull(TEXT("Inventory slots are created"), Inventory->GetSlot(NumSlots - 1)))
+		{
+			return false;
+		}
+		Inventories.Add(Inventory);
+		TArray<int32>& PlayerKeys = Keys.AddDefaulted_GetRef();
+		PlayerKeys.Init(INDEX_NONE, NumSlots);
+		CountDirtySlots(Inventory, PlayerKeys);
+	}
+
+	// Every player picks up or drops items every frame
+	double ChurnTime = 0.0;
+	int64 TotalDirty = 0;
+	int32 MaxDirtyPerFrame = 0;
+	for (int32 Frame = 0; Frame < NumFrames; ++Frame)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		for (UTEST_InventoryComponent* Inventory : Inventories)
+		{
+			for (int32 Change = 0; Change < ChangesPerFrame; ++Change)
+			{
+				if (Random.FRand() < 0.6f)
+				{
+					Inventory->AddItem(static_cast<uint8>(Random.RandRange(1, Catalog->Items.Num())), Random.RandRange(1, 3));
+				}
+				else
+				{
+					Inventory->RemoveFromSlot(Random.RandRange(0, NumSlots - 1), Random.RandRange(1, 3));
+				}
+			}
+		}
+		ChurnTime += FPlatformTime::Seconds() - StartTime;
+
+		int32 FrameDirty = 0;
+		for (int32 Player = 0; Player < NumPlayers; ++Player)
+		{
+			FrameDirty += CountDirtySlots(Inventories[Player], Keys[Player]);
+		}
+		TotalDirty += FrameDirty;
+		MaxDirtyPerFrame = FMath::Max(MaxDirtyPerFrame, FrameDirty);
+	}
+
+	// Stacks fill before new slots are used, so one change dirties at most a few slots
+	const int32 FullArraySlots = NumPlayers * NumSlots;
+	TestTrue(TEXT("Only changed slots are dirty"), MaxDirtyPerFrame < FullArraySlots);
+	AddInfo(FString::Printf(TEXT("%d players x %d slots, %d frames: %.3f us per frame, %.1f dirty slots per frame (max %d) instead of %d for whole arrays"),
+		NumPlayers, NumSlots, NumFrames, ChurnTime * 1000000.0 / NumFrames, static_cast<double>(TotalDirty) / NumFrames, MaxDirtyPerFrame, FullArraySlots));
+	return true;
+}
+
+#endif